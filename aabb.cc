@@ -0,0 +1,120 @@
+#include "aabb.hpp"
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+	#define AABB_SSE2
+	#include <emmintrin.h>
+#endif
+
+#if defined(AABB_SSE2) && defined(__GNUC__)
+	#define AABB_AVX2
+	#include <immintrin.h>
+#endif
+
+void BoxArray::clear() {
+	mLeft.clear();
+	mTop.clear();
+	mRight.clear();
+	mBottom.clear();
+}
+
+void BoxArray::push(SDL_Rect box) {
+	mLeft.push_back(box.x);
+	mTop.push_back(box.y);
+	mRight.push_back(box.x + box.w);
+	mBottom.push_back(box.y + box.h);
+}
+
+//Tests boxes [first, last) one at a time, same rules as checkCollision
+static void overlapMaskScalar(SDL_Rect box, BoxArray &boxes, int first, int last, int from, Uint32 *mask) {
+	int left = box.x, top = box.y, right = box.x + box.w, bottom = box.y + box.h;
+	const int *l = &boxes.mLeft[0], *t = &boxes.mTop[0], *r = &boxes.mRight[0], *b = &boxes.mBottom[0];
+	for(int i = from; i < last; ++i) {
+		Uint32 hit = (right > l[i]) & (left < r[i]) & (bottom > t[i]) & (top < b[i]);
+		mask[(i - first) >> 5] |= hit << ((i - first) & 31);
+	}
+}
+
+#ifndef AABB_SSE2
+static void overlapMaskPortable(SDL_Rect box, BoxArray &boxes, int first, int last, Uint32 *mask) {
+	overlapMaskScalar(box, boxes, first, last, first, mask);
+}
+#endif
+
+#ifdef AABB_SSE2
+//Four boxes per step
+static void overlapMaskSse2(SDL_Rect box, BoxArray &boxes, int first, int last, Uint32 *mask) {
+	__m128i left = _mm_set1_epi32(box.x);
+	__m128i top = _mm_set1_epi32(box.y);
+	__m128i right = _mm_set1_epi32(box.x + box.w);
+	__m128i bottom = _mm_set1_epi32(box.y + box.h);
+
+	int i = first;
+	for(; i + 4 <= last; i += 4) {
+		__m128i l = _mm_loadu_si128((const __m128i *) &boxes.mLeft[i]);
+		__m128i t = _mm_loadu_si128((const __m128i *) &boxes.mTop[i]);
+		__m128i r = _mm_loadu_si128((const __m128i *) &boxes.mRight[i]);
+		__m128i b = _mm_loadu_si128((const __m128i *) &boxes.mBottom[i]);
+		__m128i hit = _mm_and_si128(_mm_and_si128(_mm_cmpgt_epi32(right, l), _mm_cmpgt_epi32(r, left)),
+			_mm_and_si128(_mm_cmpgt_epi32(bottom, t), _mm_cmpgt_epi32(b, top)));
+		mask[(i - first) >> 5] |= (Uint32) _mm_movemask_ps(_mm_castsi128_ps(hit)) << ((i - first) & 31);
+	}
+	overlapMaskScalar(box, boxes, first, last, i, mask);
+}
+#endif
+
+#ifdef AABB_AVX2
+//Eight boxes per step, only called when the CPU has AVX2
+__attribute__((target("avx2")))
+static void overlapMaskAvx2(SDL_Rect box, BoxArray &boxes, int first, int last, Uint32 *mask) {
+	__m256i left = _mm256_set1_epi32(box.x);
+	__m256i top = _mm256_set1_epi32(box.y);
+	__m256i right = _mm256_set1_epi32(box.x + box.w);
+	__m256i bottom = _mm256_set1_epi32(box.y + box.h);
+
+	int i = first;
+	for(; i + 8 <= last; i += 8) {
+		__m256i l = _mm256_loadu_si256((const __m256i *) &boxes.mLeft[i]);
+		__m256i t = _mm256_loadu_si256((const __m256i *) &boxes.mTop[i]);
+		__m256i r = _mm256_loadu_si256((const __m256i *) &boxes.mRight[i]);
+		__m256i b = _mm256_loadu_si256((const __m256i *) &boxes.mBottom[i]);
+		__m256i hit = _mm256_and_si256(_mm256_and_si256(_mm256_cmpgt_epi32(right, l), _mm256_cmpgt_epi32(r, left)),
+			_mm256_and_si256(_mm256_cmpgt_epi32(bottom, t), _mm256_cmpgt_epi32(b, top)));
+		mask[(i - first) >> 5] |= (Uint32) _mm256_movemask_ps(_mm256_castsi256_ps(hit)) << ((i - first) & 31);
+	}
+	overlapMaskScalar(box, boxes, first, last, i, mask);
+}
+#endif
+
+typedef void (*OverlapKernel)(SDL_Rect box, BoxArray &boxes, int first, int last, Uint32 *mask);
+
+//Kernel and its name, picked once before the game starts
+static const char *gOverlapKernelName = "scalar";
+
+static OverlapKernel pickOverlapKernel() {
+#ifdef AABB_AVX2
+	if(SDL_HasAVX2()) {
+		gOverlapKernelName = "avx2";
+		return overlapMaskAvx2;
+	}
+#endif
+#ifdef AABB_SSE2
+	gOverlapKernelName = "sse2";
+	return overlapMaskSse2;
+#else
+	return overlapMaskPortable;
+#endif
+}
+
+static OverlapKernel gOverlapKernel = pickOverlapKernel();
+
+void overlapMask(SDL_Rect box, BoxArray &boxes, Uint32 *mask) {
+	memset(mask, 0, ((boxes.size() + 31) / 32) * sizeof(Uint32));
+	if(boxes.size() > 0) {
+		gOverlapKernel(box, boxes, 0, boxes.size(), mask);
+	}
+}
+
+const char *getOverlapKernelName() {
+	return gOverlapKernelName;
+}
@@ -0,0 +1,31 @@
+#ifndef AABB_HPP
+	#define AABB_HPP
+#include <SDL.h>
+#include <vector>
+
+//Boxes stored as separate arrays of edges, so many can be tested at once
+class BoxArray {
+	public:
+		//Removes every box, keeping the memory
+		void clear();
+
+		//Adds a box
+		void push(SDL_Rect box);
+
+		inline int size() {
+			return (int) mLeft.size();
+		}
+
+		//The edges, right and bottom are exclusive
+		std::vector<int> mLeft;
+		std::vector<int> mTop;
+		std::vector<int> mRight;
+		std::vector<int> mBottom;
+};
+
+//Sets bit i of mask when box overlaps boxes[i], mask needs (size + 31) / 32 words
+void overlapMask(SDL_Rect box, BoxArray &boxes, Uint32 *mask);
+
+//Name of the kernel picked for this machine
+const char *getOverlapKernelName();
+#endif
@@ -0,0 +1,329 @@
+#include "animation.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <limits.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+//Most velocity buckets in a set
+static const int MAX_VELOCITY_BUCKETS = 4096;
+
+//Which of the two animations of a bucket a motion line sets
+static const int MOTION_STILL = 0;
+static const int MOTION_MOVING = 1;
+static const int MOTION_ANY = 2;
+
+AnimationLibrary::AnimationLibrary() {
+}
+
+bool AnimationLibrary::load(std::string path) {
+	mSets.clear();
+	mAnimations.clear();
+	mFrames.clear();
+	mMotions.clear();
+	mEvents.clear();
+	mTransitions.clear();
+
+	std::ifstream file(path.c_str());
+	if(!file) {
+		printf("Unable to load animation file %s!\n", path.c_str());
+		return false;
+	}
+
+	std::vector<PendingMotion> motions;
+	std::vector<PendingTransition> transitions;
+	std::string text;
+	int line = 0;
+	while(std::getline(file, text)) {
+		++line;
+		std::istringstream words(text);
+		std::string command;
+		if(!(words >> command) || command[0] == '#') {
+			continue;
+		}
+
+		//Everything but a set goes in the last set, frames in its last animation
+		bool read = true;
+		if(command != "set" && mSets.empty()) {
+			read = false;
+		}
+		else if(command == "set") {
+			AnimationSet set;
+			int frameTime;
+			read = (bool) (words >> set.sheet >> frameTime) && frameTime > 0;
+			set.firstAnimation = (int) mAnimations.size();
+			set.animations = 0;
+			set.frameTime = frameTime / 1000.f;
+
+			//One bucket unless the set says otherwise
+			set.minVelocity = 0;
+			set.bucketSize = 1;
+			set.buckets = 1;
+			set.firstBucket = 0;
+			mSets.push_back(set);
+		}
+		else if(command == "animation") {
+			Animation animation;
+			std::string frameTime;
+			read = (bool) (words >> animation.name >> frameTime >> animation.loopFrame) && animation.loopFrame >= -1;
+			animation.firstFrame = (int) mFrames.size();
+			animation.frames = 0;
+			animation.followsSet = frameTime == "-";
+			animation.frameTime = animation.followsSet ? mSets.back().frameTime : atoi(frameTime.c_str()) / 1000.f;
+			mAnimations.push_back(animation);
+			++mSets.back().animations;
+		}
+		else if(command == "frame") {
+			SDL_Rect frame;
+			read = mSets.back().animations > 0 && (words >> frame.x >> frame.y >> frame.w >> frame.h);
+			mFrames.push_back(frame);
+			if(read) {
+				++mAnimations.back().frames;
+			}
+		}
+		else if(command == "velocity") {
+			AnimationSet &set = mSets.back();
+			float highest;
+			read = (bool) (words >> set.minVelocity >> highest >> set.bucketSize) && set.bucketSize > 0 && highest > set.minVelocity;
+			if(read) {
+				set.buckets = (int) ceil((highest - set.minVelocity) / set.bucketSize);
+				read = set.buckets <= MAX_VELOCITY_BUCKETS;
+			}
+		}
+		else if(command == "motion") {
+			PendingMotion motion;
+			std::string moving;
+			read = (bool) (words >> motion.animation >> moving);
+			motion.set = (int) mSets.size() - 1;
+			motion.moving = moving == "still" ? MOTION_STILL : moving == "moving" ? MOTION_MOVING : MOTION_ANY;
+			read = read && (motion.moving != MOTION_ANY || moving == "any");
+			motion.ranged = (bool) (words >> motion.from >> motion.to);
+			read = read && (!motion.ranged || motion.to > motion.from);
+			motion.line = line;
+			motions.push_back(motion);
+		}
+		else if(command == "on") {
+			PendingTransition transition;
+			read = (bool) (words >> transition.event >> transition.from >> transition.firstFrame >> transition.lastFrame >> transition.action);
+			transition.set = (int) mSets.size() - 1;
+			transition.line = line;
+			transitions.push_back(transition);
+		}
+		else {
+			read = false;
+		}
+
+		if(!read) {
+			printf("Unable to read %s line %d!\n", path.c_str(), line);
+			return false;
+		}
+	}
+
+	return resolve(path, motions, transitions);
+}
+
+bool AnimationLibrary::resolve(std::string path, std::vector<PendingMotion> &motions, std::vector<PendingTransition> &transitions) {
+	for(unsigned int i = 0; i < mAnimations.size(); ++i) {
+		if(mAnimations[i].frames == 0 || mAnimations[i].loopFrame >= mAnimations[i].frames) {
+			printf("Animation %s in %s has no frames or loops past them!\n", mAnimations[i].name.c_str(), path.c_str());
+			return false;
+		}
+	}
+
+	//Buckets nothing picks for show the first animation of the set
+	for(unsigned int i = 0; i < mSets.size(); ++i) {
+		if(mSets[i].animations == 0) {
+			printf("Set %s in %s has no animations!\n", mSets[i].sheet.c_str(), path.c_str());
+			return false;
+		}
+		mSets[i].firstBucket = (int) mMotions.size();
+		mMotions.insert(mMotions.end(), mSets[i].buckets * 2, mSets[i].firstAnimation);
+	}
+
+	//Later lines win where ranges overlap
+	for(unsigned int i = 0; i < motions.size(); ++i) {
+		const PendingMotion &motion = motions[i];
+		const AnimationSet &set = mSets[motion.set];
+		int animation = findAnimation(motion.set, motion.animation);
+		if(animation < 0) {
+			printf("Unknown animation %s on %s line %d!\n", motion.animation.c_str(), path.c_str(), motion.line);
+			return false;
+		}
+
+		int first = 0;
+		int last = set.buckets - 1;
+		if(motion.ranged) {
+			first = std::max(first, (int) floor((motion.from - set.minVelocity) / set.bucketSize));
+			last = std::min(last, (int) ceil((motion.to - set.minVelocity) / set.bucketSize) - 1);
+		}
+		for(int bucket = first; bucket <= last; ++bucket) {
+			for(int moving = MOTION_STILL; moving <= MOTION_MOVING; ++moving) {
+				if(motion.moving == MOTION_ANY || motion.moving == moving) {
+					mMotions[set.firstBucket + bucket * 2 + moving] = animation;
+				}
+			}
+		}
+	}
+
+	//Whatever velocity can pick, the first animations included
+	std::vector<bool> isMotion(mAnimations.size(), false);
+	for(unsigned int i = 0; i < mMotions.size(); ++i) {
+		isMotion[mMotions[i]] = true;
+	}
+
+	//Every event any set uses gets a column
+	for(unsigned int i = 0; i < transitions.size(); ++i) {
+		if(findEvent(transitions[i].event) < 0) {
+			mEvents.push_back(transitions[i].event);
+		}
+	}
+	Transition none = {0, -1, -1};
+	mTransitions.assign(mAnimations.size() * mEvents.size(), none);
+
+	//Transitions from motion come from every animation velocity picks in the set
+	for(unsigned int i = 0; i < transitions.size(); ++i) {
+		const PendingTransition &pending = transitions[i];
+		Transition transition = {pending.firstFrame, pending.lastFrame < 0 ? INT_MAX : pending.lastFrame, findAnimation(pending.set, pending.action)};
+		int from = pending.from == "motion" ? -1 : findAnimation(pending.set, pending.from);
+		if(transition.action < 0 || (from < 0 && pending.from != "motion")) {
+			printf("Unknown animation on %s line %d!\n", path.c_str(), pending.line);
+			return false;
+		}
+
+		int event = findEvent(pending.event);
+		const AnimationSet &set = mSets[pending.set];
+		for(int animation = set.firstAnimation; animation < set.firstAnimation + set.animations; ++animation) {
+			if(animation == from || (from < 0 && isMotion[animation])) {
+				mTransitions[animation * mEvents.size() + event] = transition;
+			}
+		}
+	}
+	return true;
+}
+
+int AnimationLibrary::findSet(std::string sheet) {
+	for(unsigned int i = 0; i < mSets.size(); ++i) {
+		if(mSets[i].sheet == sheet) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+int AnimationLibrary::findAnimation(int set, std::string name) {
+	if(set < 0) {
+		return -1;
+	}
+	for(int i = mSets[set].firstAnimation; i < mSets[set].firstAnimation + mSets[set].animations; ++i) {
+		if(mAnimations[i].name == name) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+int AnimationLibrary::findEvent(std::string name) {
+	for(unsigned int i = 0; i < mEvents.size(); ++i) {
+		if(mEvents[i] == name) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+void AnimationLibrary::setFrameTime(int set, int frameTime) {
+	if(set < 0 || frameTime <= 0) {
+		return;
+	}
+	mSets[set].frameTime = frameTime / 1000.f;
+	for(int i = mSets[set].firstAnimation; i < mSets[set].firstAnimation + mSets[set].animations; ++i) {
+		if(mAnimations[i].followsSet) {
+			mAnimations[i].frameTime = mSets[set].frameTime;
+		}
+	}
+}
+
+void AnimationLibrary::start(AnimationState &state, int set) {
+	state.set = set;
+	state.animation = -1;
+	state.frame = 0;
+	state.time = 0;
+	state.action = false;
+	if(set >= 0) {
+		enter(state, mSets[set].firstAnimation, false);
+	}
+}
+
+void AnimationLibrary::trigger(AnimationState &state, int event) {
+	if(state.set < 0 || event < 0) {
+		return;
+	}
+	const Transition &transition = mTransitions[state.animation * mEvents.size() + event];
+	if(transition.action >= 0 && state.frame >= transition.firstFrame && state.frame <= transition.lastFrame) {
+		enter(state, transition.action, true);
+	}
+}
+
+void AnimationLibrary::advance(AnimationState &state, bool moving, float velocityY, float timeStep) {
+	if(state.set < 0) {
+		return;
+	}
+
+	//An action plays out first
+	bool ended = false;
+	if(state.action) {
+		if(play(state, timeStep)) {
+			return;
+		}
+		ended = true;
+	}
+
+	//Then velocity picks, out of range goes to the nearest bucket
+	const AnimationSet &set = mSets[state.set];
+	float position = (velocityY - set.minVelocity) / set.bucketSize;
+	int bucket = position <= 0 ? 0 : position >= set.buckets ? set.buckets - 1 : (int) position;
+	int animation = mMotions[set.firstBucket + bucket * 2 + (moving ? 1 : 0)];
+	if(ended || animation != state.animation) {
+		enter(state, animation, false);
+	}
+	else {
+		play(state, timeStep);
+	}
+}
+
+bool AnimationLibrary::play(AnimationState &state, float timeStep) {
+	const Animation &animation = mAnimations[state.animation];
+	if(animation.frameTime <= 0) {
+		return true;
+	}
+
+	state.time += timeStep;
+	while(state.time >= animation.frameTime) {
+		state.time -= animation.frameTime;
+		if(++state.frame == animation.frames) {
+			//Played once, stays on the last frame
+			if(animation.loopFrame < 0) {
+				state.frame = animation.frames - 1;
+				return false;
+			}
+			state.frame = animation.loopFrame;
+		}
+	}
+	return true;
+}
+
+void AnimationLibrary::enter(AnimationState &state, int animation, bool action) {
+	state.animation = animation;
+	state.frame = 0;
+	state.time = 0;
+	state.action = action;
+}
+
+SDL_Rect *AnimationLibrary::getClip(const AnimationState &state) {
+	if(state.set < 0) {
+		return NULL;
+	}
+	return &mFrames[mAnimations[state.animation].firstFrame + state.frame];
+}
@@ -0,0 +1,138 @@
+#ifndef ANIMATION_HPP
+	#define ANIMATION_HPP
+#include <SDL.h>
+#include <string>
+#include <vector>
+
+//Where an entity is in its animations, moved on by the simulation step and only read when drawing
+struct AnimationState {
+	//Set of the entity's sheet, -1 when there is none
+	int set;
+
+	//Animation playing, its frame and the seconds spent on the frame
+	int animation;
+	int frame;
+	float time;
+
+	//Started by an event, it plays out before velocity picks again
+	bool action;
+};
+
+//Animation sets and their transitions read from a data file into flat tables
+//When no action plays, velocity picks the animation out of a table of buckets, so a step costs a lookup
+class AnimationLibrary {
+	public:
+		//Initializes an empty library
+		AnimationLibrary();
+
+		//Reads the sets in path, replacing those loaded before
+		bool load(std::string path);
+
+		//Set of a sprite sheet, -1 if there is none
+		int findSet(std::string sheet);
+
+		//Animation of a set by name, -1 if there is none
+		int findAnimation(int set, std::string name);
+
+		//Event used by some transition, -1 if none uses it
+		int findEvent(std::string name);
+
+		//Sets the frame time of the set's animations that follow the set, in milliseconds
+		void setFrameTime(int set, int frameTime);
+
+		//Puts a state on the first animation of a set
+		void start(AnimationState &state, int set);
+
+		//Plays the action an event leads to from the current frame, if any
+		void trigger(AnimationState &state, int event);
+
+		//Moves a state on by a step, velocity picks the animation once no action plays
+		void advance(AnimationState &state, bool moving, float velocityY, float timeStep);
+
+		//Frame to draw, NULL when the state has no set
+		SDL_Rect *getClip(const AnimationState &state);
+
+	private:
+		struct Animation {
+			std::string name;
+
+			//Range of mFrames
+			int firstFrame;
+			int frames;
+
+			//Frame a loop goes back to, -1 plays once
+			int loopFrame;
+
+			//Seconds a frame shows, set by the set when followsSet
+			float frameTime;
+			bool followsSet;
+		};
+
+		struct AnimationSet {
+			std::string sheet;
+
+			//Range of mAnimations
+			int firstAnimation;
+			int animations;
+
+			//Seconds a frame shows in the animations that follow the set
+			float frameTime;
+
+			//Vertical velocity buckets from minVelocity, their animations start at firstBucket in mMotions
+			float minVelocity;
+			float bucketSize;
+			int buckets;
+			int firstBucket;
+		};
+
+		//Action an event plays from a range of frames, -1 for none
+		struct Transition {
+			int firstFrame;
+			int lastFrame;
+			int action;
+		};
+
+		//Lines naming animations, resolved once the whole file is read
+		struct PendingMotion {
+			int set;
+			std::string animation;
+			int moving;
+
+			//Velocity range, the whole table when not ranged
+			bool ranged;
+			float from, to;
+			int line;
+		};
+
+		struct PendingTransition {
+			int set;
+			std::string event;
+			std::string from;
+			int firstFrame, lastFrame;
+			std::string action;
+			int line;
+		};
+
+		//Fills the bucket and transition tables
+		bool resolve(std::string path, std::vector<PendingMotion> &motions, std::vector<PendingTransition> &transitions);
+
+		//Moves through the frames, false once an animation that plays once is over
+		bool play(AnimationState &state, float timeStep);
+
+		//Goes to an animation from its first frame
+		void enter(AnimationState &state, int animation, bool action);
+
+		std::vector<AnimationSet> mSets;
+		std::vector<Animation> mAnimations;
+		std::vector<SDL_Rect> mFrames;
+
+		//Two animations per bucket, standing still then moving
+		std::vector<int> mMotions;
+
+		//One row of events per animation
+		std::vector<std::string> mEvents;
+		std::vector<Transition> mTransitions;
+};
+
+extern AnimationLibrary gAnimations;
+#endif
@@ -0,0 +1,176 @@
+#include "assetloader.hpp"
+#include "globals.hpp"
+#include "texturecache.hpp"
+#include <SDL_image.h>
+
+AssetLoader::AssetLoader(int totalWorkers) {
+	mTotal = 0;
+	mTotalDecoded = 0;
+	mTotalUploaded = 0;
+	mFailed = false;
+	mQuit = false;
+
+	//Loads also wait on the disk, so use a few more workers than cores on small machines
+	if(totalWorkers < 0) {
+		totalWorkers = std::thread::hardware_concurrency();
+		if(totalWorkers < MIN_ASSET_WORKERS) {
+			totalWorkers = MIN_ASSET_WORKERS;
+		}
+	}
+	if(totalWorkers < 1) {
+		totalWorkers = 1;
+	}
+	for(int i = 0; i < totalWorkers; ++i) {
+		mWorkers.push_back(std::thread(&AssetLoader::decodeLoop, this));
+	}
+}
+
+AssetLoader::~AssetLoader() {
+	{
+		std::lock_guard<std::mutex> guard(mLock);
+		mQuit = true;
+	}
+	mWake.notify_all();
+	for(unsigned int i = 0; i < mWorkers.size(); ++i) {
+		mWorkers[i].join();
+	}
+
+	//Drop what was never uploaded
+	mQueue.insert(mQueue.end(), mDecoded.begin(), mDecoded.end());
+	for(unsigned int i = 0; i < mQueue.size(); ++i) {
+		if(mQueue[i]->surface != NULL) {
+			SDL_FreeSurface(mQueue[i]->surface);
+		}
+		delete mQueue[i];
+	}
+}
+
+void AssetLoader::addImage(std::string path, LTexture *texture) {
+	Asset *asset = new Asset();
+	asset->path = path;
+	asset->texture = texture;
+	asset->surface = NULL;
+	asset->decoded = false;
+	{
+		std::lock_guard<std::mutex> guard(mLock);
+		mQueue.push_back(asset);
+		++mTotal;
+	}
+	mWake.notify_one();
+}
+
+void AssetLoader::add(std::function<bool()> decode, std::function<bool()> upload) {
+	Asset *asset = new Asset();
+	asset->texture = NULL;
+	asset->surface = NULL;
+	asset->decode = decode;
+	asset->upload = upload;
+	asset->decoded = false;
+	{
+		std::lock_guard<std::mutex> guard(mLock);
+		mQueue.push_back(asset);
+		++mTotal;
+	}
+	mWake.notify_one();
+}
+
+void AssetLoader::upload(Uint32 budget) {
+	Uint32 start = SDL_GetTicks();
+	for(;;) {
+		Asset *asset;
+		{
+			std::lock_guard<std::mutex> guard(mLock);
+			if(mDecoded.empty()) {
+				return;
+			}
+			asset = mDecoded.front();
+			mDecoded.pop_front();
+		}
+
+		bool uploaded = uploadAsset(*asset);
+		delete asset;
+		{
+			std::lock_guard<std::mutex> guard(mLock);
+			++mTotalUploaded;
+			if(!uploaded) {
+				mFailed = true;
+			}
+		}
+
+		if(SDL_GetTicks() - start >= budget) {
+			return;
+		}
+	}
+}
+
+bool AssetLoader::isDone() {
+	std::lock_guard<std::mutex> guard(mLock);
+	return mTotalUploaded == mTotal;
+}
+
+float AssetLoader::getProgress() {
+	std::lock_guard<std::mutex> guard(mLock);
+	if(mTotal == 0) {
+		return 1;
+	}
+
+	//Decoding and uploading count as half each
+	return (mTotalDecoded + mTotalUploaded) / (2.f * mTotal);
+}
+
+bool AssetLoader::hasFailed() {
+	std::lock_guard<std::mutex> guard(mLock);
+	return mFailed;
+}
+
+void AssetLoader::decodeLoop() {
+	std::unique_lock<std::mutex> lock(mLock);
+	for(;;) {
+		mWake.wait(lock, [this] { return mQuit || !mQueue.empty(); });
+		if(mQuit) {
+			return;
+		}
+		Asset *asset = mQueue.front();
+		mQueue.pop_front();
+
+		//Decode without holding the lock
+		lock.unlock();
+		if(!asset->path.empty()) {
+			asset->surface = IMG_Load(asset->path.c_str());
+			if(asset->surface == NULL) {
+				printf("Unable to load image %s! SDL_image Error: %s\n", asset->path.c_str(), IMG_GetError());
+			}
+			asset->decoded = asset->surface != NULL;
+		}
+		else {
+			asset->decoded = asset->decode();
+		}
+		lock.lock();
+
+		//Failed assets still go through the main thread so they are counted
+		++mTotalDecoded;
+		mDecoded.push_back(asset);
+	}
+}
+
+bool AssetLoader::uploadAsset(Asset &asset) {
+	if(!asset.decoded) {
+		return false;
+	}
+
+	bool uploaded = true;
+	if(!asset.path.empty()) {
+		if(asset.texture != NULL) {
+			uploaded = asset.texture->loadFromSurface(asset.surface, asset.path);
+		}
+		else {
+			uploaded = (bool) gTextureCache.insert(asset.path, asset.surface);
+		}
+		SDL_FreeSurface(asset.surface);
+		asset.surface = NULL;
+	}
+	else if(asset.upload) {
+		uploaded = asset.upload();
+	}
+	return uploaded;
+}
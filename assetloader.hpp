@@ -0,0 +1,77 @@
+#ifndef ASSETLOADER_HPP
+	#define ASSETLOADER_HPP
+#include <SDL.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "texture.hpp"
+
+//Decodes assets on worker threads in parallel, then finishes them on the main thread
+//Textures can only be created on the main thread, so upload() is called there between frames
+class AssetLoader {
+	public:
+		//Starts the workers, by default one per core but at least MIN_ASSET_WORKERS
+		AssetLoader(int totalWorkers = -1);
+
+		//Waits for the assets being decoded and stops the workers
+		~AssetLoader();
+
+		//Decodes an image into a texture, or into the texture cache when texture is NULL
+		void addImage(std::string path, LTexture *texture = NULL);
+
+		//Runs decode on a worker, then upload on the main thread if it succeeded
+		void add(std::function<bool()> decode, std::function<bool()> upload = std::function<bool()>());
+
+		//Uploads decoded assets for about budget milliseconds, at least one if any are ready
+		void upload(Uint32 budget);
+
+		//Every asset is uploaded
+		bool isDone();
+
+		//Share of the work done, from 0 to 1
+		float getProgress();
+
+		//An asset failed to decode or upload
+		bool hasFailed();
+
+	private:
+		struct Asset {
+			//Image to decode, empty for other assets
+			std::string path;
+
+			//Texture for the image, NULL for the texture cache
+			LTexture *texture;
+			SDL_Surface *surface;
+
+			//Steps of other assets
+			std::function<bool()> decode;
+			std::function<bool()> upload;
+
+			bool decoded;
+		};
+
+		//Decodes assets until told to quit
+		void decodeLoop();
+
+		//Finishes a decoded asset on the main thread
+		bool uploadAsset(Asset &asset);
+
+		std::vector<std::thread> mWorkers;
+		std::mutex mLock;
+		std::condition_variable mWake;
+
+		//Assets waiting for a worker, and decoded ones waiting for the main thread
+		std::deque<Asset *> mQueue;
+		std::deque<Asset *> mDecoded;
+
+		int mTotal;
+		int mTotalDecoded;
+		int mTotalUploaded;
+		bool mFailed;
+		bool mQuit;
+};
+#endif
@@ -0,0 +1,372 @@
+//Microbenchmarks of the collision, level loading and entity update paths, run without a window
+//Prints one JSON object per benchmark with the time and heap allocations per op
+//Run from the game directory so the maps are found
+//Usage: gamebench [name filter]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <new>
+#include <fstream>
+#include "../world.hpp"
+#include "../tiletypes.hpp"
+#include "../globals.hpp"
+#include "../animation.hpp"
+#include "../aabb.hpp"
+
+//Time a benchmark runs for, at least
+const double BENCH_SECONDS = 0.25;
+
+//Steps the character walks before starting over, less than it takes to cross the smallest level
+const int BENCH_WALK_STEPS = 240;
+
+//Boxes the collision benchmarks cycle through, a power of two
+const int BENCH_BOXES = 4096;
+
+//Heap allocations so far, from any thread
+static std::atomic<unsigned long long> gAllocations(0);
+
+//Results end up here so the work is not optimized away
+static volatile long long gSink;
+
+//Only benchmarks with this in their name run
+static std::string gFilter;
+
+//Counts every heap allocation
+//The deletes stay out of line, inlined they look like free() on memory from new to the compiler
+void *operator new(size_t size) {
+	gAllocations.fetch_add(1, std::memory_order_relaxed);
+	void *memory = malloc(size != 0 ? size : 1);
+	if(memory == NULL) {
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void *operator new[](size_t size) {
+	return operator new(size);
+}
+
+__attribute__((noinline)) void operator delete(void *memory) noexcept {
+	free(memory);
+}
+
+__attribute__((noinline)) void operator delete[](void *memory) noexcept {
+	free(memory);
+}
+
+//Runs batch(iterations) with twice the iterations each time until a run takes BENCH_SECONDS, then prints the last run
+template<typename Batch>
+void run(std::string name, Batch batch) {
+	if(name.find(gFilter) == std::string::npos) {
+		return;
+	}
+
+	long long iterations = 1;
+	for(;;) {
+		unsigned long long allocations = gAllocations.load();
+		Uint64 start = SDL_GetPerformanceCounter();
+		batch(iterations);
+		double seconds = (SDL_GetPerformanceCounter() - start) / (double) SDL_GetPerformanceFrequency();
+		allocations = gAllocations.load() - allocations;
+
+		if(seconds >= BENCH_SECONDS || iterations >= (1ll << 40)) {
+			printf("{\"name\": \"%s\", \"iterations\": %lld, \"ns_per_op\": %.3f, \"allocs_per_op\": %.3f}\n", name.c_str(), iterations, seconds * 1e9 / iterations, (double) allocations / iterations);
+			fflush(stdout);
+			return;
+		}
+		iterations *= 2;
+	}
+}
+
+//Boxes of a size scattered over the level
+std::vector<SDL_Rect> makeBoxes(TileMap &tiles, Random &random, int width, int height) {
+	std::vector<SDL_Rect> boxes(BENCH_BOXES);
+	for(int i = 0; i < BENCH_BOXES; ++i) {
+		boxes[i].x = random.range(tiles.getWidth() - width);
+		boxes[i].y = random.range(tiles.getHeight() - height);
+		boxes[i].w = width;
+		boxes[i].h = height;
+	}
+	return boxes;
+}
+
+//A map or its level file is around, setTiles would complain on stdout otherwise
+bool hasMap(std::string map) {
+	std::ifstream text(map);
+	std::ifstream level(map.substr(0, map.rfind('.')) + ".lvl");
+	return text.good() || level.good();
+}
+
+//A level with a floor and every tile type scattered over it, for when the maps are not around
+//The character drops down the left columns and walks along the floor, those are kept clear
+void makeLevel(TileMap &tiles, Random &random) {
+	tiles.reset(DEFAULT_LEVEL_COLUMNS, DEFAULT_LEVEL_ROWS);
+	for(int i = 0; i < (DEFAULT_LEVEL_ROWS - 1) * DEFAULT_LEVEL_COLUMNS; ++i) {
+		bool clear = i % DEFAULT_LEVEL_COLUMNS < 3 || i / DEFAULT_LEVEL_COLUMNS >= DEFAULT_LEVEL_ROWS - 3;
+		if(random.range(4) == 0 && !clear) {
+			tiles.setTile(i, random.range(TOTAL_TILE_SPRITES));
+		}
+	}
+	for(int i = 0; i < TOTAL_TILE_SPRITES; ++i) {
+		if(gTileTypeFlags[i] == TILE_WALL) {
+			for(int column = 0; column < DEFAULT_LEVEL_COLUMNS; ++column) {
+				tiles.setTile((DEFAULT_LEVEL_ROWS - 1) * DEFAULT_LEVEL_COLUMNS + column, i);
+			}
+			break;
+		}
+	}
+}
+
+//Collision of boxes with each other and with the level
+void benchCollision(TileMap &tiles, Random &random) {
+	std::vector<SDL_Rect> boxes = makeBoxes(tiles, random, 65, 80);
+
+	run("checkCollision", [&](long long iterations) {
+		long long hits = 0;
+		for(long long i = 0; i < iterations; ++i) {
+			hits += checkCollision(boxes[i & (BENCH_BOXES - 1)], boxes[(i + 1) & (BENCH_BOXES - 1)]);
+		}
+		gSink = hits;
+	});
+
+	//One box against a batch of boxes the way a spatial hash bucket tests them, with the overlap kernel picked for this machine and with checkCollision on one box at a time
+	const int batches[3] = {8, 64, 512};
+	for(int n = 0; n < 3; ++n) {
+		int size = batches[n];
+		BoxArray batch;
+		for(int i = 0; i < size; ++i) {
+			batch.push(boxes[i]);
+		}
+		std::vector<Uint32> mask((size + 31) / 32);
+		std::string boxCount = "/boxes=" + std::to_string(size);
+
+		run(std::string("overlapMask/") + getOverlapKernelName() + boxCount, [&](long long iterations) {
+			long long hits = 0;
+			for(long long i = 0; i < iterations; ++i) {
+				overlapMask(boxes[i & (BENCH_BOXES - 1)], batch, &mask[0]);
+				hits += mask[0];
+			}
+			gSink = hits;
+		});
+
+		run("checkCollision" + boxCount, [&](long long iterations) {
+			long long hits = 0;
+			for(long long i = 0; i < iterations; ++i) {
+				SDL_Rect box = boxes[i & (BENCH_BOXES - 1)];
+				memset(&mask[0], 0, mask.size() * sizeof(Uint32));
+				for(int j = 0; j < size; ++j) {
+					mask[j >> 5] |= (Uint32) checkCollision(box, boxes[j]) << (j & 31);
+				}
+				hits += mask[0];
+			}
+			gSink = hits;
+		});
+	}
+
+	run("touchesWall", [&](long long iterations) {
+		long long hits = 0;
+		SDL_Rect contact;
+		for(long long i = 0; i < iterations; ++i) {
+			hits += touchesWall(boxes[i & (BENCH_BOXES - 1)], tiles, contact) >= 0;
+		}
+		gSink = hits;
+	});
+
+	run("touchesTap", [&](long long iterations) {
+		long long hits = 0;
+		for(long long i = 0; i < iterations; ++i) {
+			hits += touchesTap(boxes[i & (BENCH_BOXES - 1)], tiles);
+		}
+		gSink = hits;
+	});
+
+	//Boxes over the sloped tiles, the diagonal collision the walls go through
+	std::vector<int> slopes;
+	for(int i = 0; i < tiles.getTotalTiles(); ++i) {
+		if(tiles.isDiagonal(i)) {
+			slopes.push_back(i);
+		}
+	}
+	if(slopes.empty()) {
+		fprintf(stderr, "no sloped tiles, skipping touchesSlope\n");
+		return;
+	}
+	std::vector<SDL_Rect> slopeBoxes(BENCH_BOXES);
+	for(int i = 0; i < BENCH_BOXES; ++i) {
+		SDL_Rect tile = tiles.getBox(slopes[i % slopes.size()]);
+		slopeBoxes[i].x = tile.x + random.range(TILE_WIDTH) - 32;
+		slopeBoxes[i].y = tile.y + random.range(TILE_HEIGHT) - 40;
+		slopeBoxes[i].w = 65;
+		slopeBoxes[i].h = 80;
+	}
+	run("touchesSlope", [&](long long iterations) {
+		long long hits = 0;
+		SDL_Rect contact;
+		for(long long i = 0; i < iterations; ++i) {
+			int box = i & (BENCH_BOXES - 1);
+			hits += tiles.touchesSlope(slopes[box % slopes.size()], slopeBoxes[box], contact);
+		}
+		gSink = hits;
+	});
+}
+
+//Loading each shipped map the way the game does, from its level file when there is one
+void benchMaps() {
+	const char *maps[3] = {"lazy.map", "lazy2.map", "lazy3.map"};
+	for(int i = 0; i < 3; ++i) {
+		std::string map = maps[i];
+		TileMap tiles;
+		if(!hasMap(map) || !setTiles(tiles, map)) {
+			fprintf(stderr, "no %s, skipping setTiles on it\n", map.c_str());
+			continue;
+		}
+		run("setTiles/" + map, [&](long long iterations) {
+			for(long long n = 0; n < iterations; ++n) {
+				setTiles(tiles, map);
+			}
+			gSink = tiles.getTotalTiles();
+		});
+	}
+}
+
+//The character and npc updates with a crowd of npcs
+void benchEntities(TileMap &tiles, Random &random, JobSystem &jobs, int totalNpcs) {
+	const char *npcSheets[5] = {"character2.png", "character2.png", "character3.png", "character1.png", "character4.png"};
+	std::vector<NpcSpawn> npcSpawns;
+	std::vector<Npc *> npcVector;
+	for(int i = 0; i < totalNpcs; ++i) {
+		std::string sheet = npcSheets[i % 5];
+		NpcSpawn spawn = {random.range(tiles.getWidth() - getNpcWidth(sheet)), random.range(tiles.getHeight() - getNpcHeight(sheet)), sheet, random.next()};
+		npcSpawns.push_back(spawn);
+		npcVector.push_back(spawnNpc(spawn));
+	}
+	thinkNpcs(npcVector, random);
+
+	SpatialHash npcHash;
+	hashNpcs(npcVector, npcHash);
+	std::vector<NpcHit> npcHits;
+	float timeStep = 1.f / gSimulationRate;
+	std::string crowd = "/npcs=" + std::to_string(totalNpcs);
+
+	std::vector<SDL_Rect> boxes = makeBoxes(tiles, random, 65, 80);
+	run("touchesNpc" + crowd, [&](long long iterations) {
+		long long hits = 0;
+		for(long long i = 0; i < iterations; ++i) {
+			hits += touchesNpc(boxes[i & (BENCH_BOXES - 1)], npcHash) >= 0;
+		}
+		gSink = hits;
+	});
+
+	//The character walks right through the crowd, what it does to the npcs is not applied
+	//It starts over before reaching the end of the level, so every op is a real move
+	Character character(65, 80);
+	SDL_Event walk;
+	walk.type = SDL_KEYDOWN;
+	walk.key.repeat = 0;
+	walk.key.keysym.sym = SDLK_d;
+	run("Character::move" + crowd, [&](long long iterations) {
+		for(long long i = 0; i < iterations; ++i) {
+			if(i % BENCH_WALK_STEPS == 0) {
+				character.reset();
+				character.handleEvent(walk);
+			}
+			character.savePosition();
+			npcHits.clear();
+			character.move(tiles, npcVector, npcHash, npcHits, timeStep);
+		}
+		gSink = npcHits.size();
+	});
+
+	//One npc moved per op, going round the crowd, the cost of a single npc whatever the crowd
+	CharacterState state = character.getState();
+	run("Npc::move" + crowd, [&](long long iterations) {
+		for(long long i = 0; i < iterations; ++i) {
+			Npc *npc = npcVector[i % totalNpcs];
+			npc->savePosition();
+			npc->move(tiles, state, timeStep);
+		}
+		gSink = npcVector[0]->getBoxPosition().x;
+	});
+
+	//One npc animation moved on per op, a bucket lookup and maybe a frame
+	run("Npc::animate" + crowd, [&](long long iterations) {
+		for(long long i = 0; i < iterations; ++i) {
+			npcVector[i % totalNpcs]->animate(timeStep);
+		}
+		gSink = npcVector[0]->animation.frame;
+	});
+
+	for(unsigned int i = 0; i < npcVector.size(); ++i) {
+		delete npcVector[i];
+	}
+	npcVector.clear();
+
+	//One whole step per op, npcs thinking as in the game while the character walks through them
+	//The crowd is spawned again when the walk starts over, bringing back the npcs jumped on, its allocations count in the ops
+	ParticlePool particles;
+	run("stepSimulation" + crowd, [&](long long iterations) {
+		for(long long i = 0; i < iterations; ++i) {
+			Uint32 step = i % BENCH_WALK_STEPS;
+			if(step == 0) {
+				for(unsigned int n = 0; n < npcVector.size(); ++n) {
+					delete npcVector[n];
+				}
+				npcVector.clear();
+				for(unsigned int n = 0; n < npcSpawns.size(); ++n) {
+					npcVector.push_back(spawnNpc(npcSpawns[n]));
+				}
+				thinkNpcs(npcVector, random);
+				particles.clear();
+				character.reset();
+				character.handleEvent(walk);
+			}
+			updateNpcs(npcVector, random, step);
+			stepSimulation(tiles, character, npcVector, npcHash, npcHits, particles, jobs, timeStep);
+		}
+		gSink = npcVector.size();
+	});
+
+	for(unsigned int i = 0; i < npcVector.size(); ++i) {
+		delete npcVector[i];
+	}
+}
+
+int main(int argc, char *args[]) {
+	if(argc > 2) {
+		fprintf(stderr, "usage: %s [name filter]\n", args[0]);
+		return 1;
+	}
+	if(argc == 2) {
+		gFilter = args[1];
+	}
+
+	//Nothing is drawn, npcs and the character load no sheets
+	gHeadless = true;
+	gScale = 1;
+
+	//Without the file npcs have no animations, which only makes animate cheaper
+	if(!gAnimations.load("animations.txt")) {
+		fprintf(stderr, "no animations.txt, npcs are not animated\n");
+	}
+
+	Random random(1);
+	TileMap tiles;
+	if(!hasMap("lazy.map") || !setTiles(tiles, "lazy.map")) {
+		fprintf(stderr, "no lazy.map, using a generated level\n");
+		makeLevel(tiles, random);
+	}
+
+	benchCollision(tiles, random);
+	benchMaps();
+	JobSystem jobs;
+	const int crowds[4] = {10, 100, 1000, 10000};
+	for(int i = 0; i < 4; ++i) {
+		benchEntities(tiles, random, jobs, crowds[i]);
+	}
+
+	tiles.clear();
+	return 0;
+}
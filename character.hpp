@@ -1,11 +1,22 @@
 #ifndef CHARACTER_HPP
 	#define CHARACTER_HPP
 #include <vector>
+#include <memory>
 #include "globals.hpp"
-#include "tiles.hpp"
+#include "fixed.hpp"
+#include "tilemap.hpp"
 #include "npc.hpp"
 #include "particle.hpp"
-#include "timer.hpp"
+#include "animation.hpp"
+
+//What npcs see of the character, copied once per step
+struct CharacterState {
+	SDL_Rect box;
+	Real posX, posY;
+	int width, height;
+	bool isAttacking;
+	SDL_RendererFlip flip;
+};
 
 class Character {
 	public:
@@ -13,21 +24,9 @@ class Character {
 
 		const int CHARACTER_WIDTH;// = 65;
 		const int CHARACTER_HEIGHT;// = 80;
-		static const int ANIMATION_FRAMES = 16;
-		static const int JUMPING_FRAMES = 6;
-		static const int FALLING_FRAMES = 6;
-		static const int ATTACKING_FRAMES = 12;
-		static const int SECOND_ATTACKING_FRAMES = 10;
-		static const int SPRITESHEET_WIDTH = 858;
-		//static const int SPRITESHEET_HEIGHT = 40;
-
-		// Clip containers.
-		LTexture characterTexture;
-		SDL_Rect spriteClips[ANIMATION_FRAMES];
-		SDL_Rect jumpClips[JUMPING_FRAMES];
-		SDL_Rect fallClips[FALLING_FRAMES];
-		SDL_Rect attackClips[ATTACKING_FRAMES];
-		SDL_Rect secondAttackClips[SECOND_ATTACKING_FRAMES];
+
+		// Sprite sheet, from the texture cache.
+		std::shared_ptr<LTexture> characterTexture;
 
 		//Maximum axis velocity of the character
 		const int CHARACTER_VELY = 15 * 60; // * SCREEN_FPS; // 15;
@@ -39,39 +38,44 @@ class Character {
 		bool tileTap = false;
 		bool oscillate = false;
 
-		// Animation.
-		SDL_Rect *currentClip = NULL;
-		int frameRate;
-
+		// Animation, the attacks and their frame are read from it.
+		AnimationState animation;
+		bool secondAttack = false;
 		int attackingFrame;
-		int walkingFrame;
-		int fallingFrame;
 
-		LTimer attackingTimer;
-		LTimer fallingTimer;
-		LTimer walkingTimer;
+		// Particles trailing the character.
+		ParticleEmitter particleEmitter;
 
-		bool firstAttack = false;
-		bool secondAttack = false;
-		bool firstWalk = false;
-
-		//Initializes the variables allocates particles.
+		//Initializes the variables
 		Character(int width, int height);
 
-		// Deallocates particles.
-		~Character();
+		//Puts the character back at the start of the level, keeping its sheet
+		void reset();
 
 		//Takes key presses and adjusts the character's velocity
 		void handleEvent(SDL_Event &e);
 
 		//Moves the character and check collision against tiles
-		void move(Tile *tiles[], std::vector<Npc *> &npcVector, float timeStep);
+		//Npcs are only read, what the character does to them is added to npcHits
+		void move(TileMap &tiles, std::vector<Npc *> &npcVector, SpatialHash &npcHash, std::vector<NpcHit> &npcHits, float timeStep);
+
+		//Moves the animation on by a step, after the move
+		void animate(float timeStep);
+
+		//Snapshot for the npc update
+		CharacterState getState();
+
+		//Remembers where the step started, for render interpolation
+		void savePosition();
+
+		//Places the render box between the last two steps
+		void interpolate(float alpha);
 
 		//Centers the camera over the character
-		void setCamera(SDL_Rect &camera);
+		void setCamera(SDL_Rect &camera, TileMap &tiles);
 
 		//Shows the character on the screen
-		void render(SDL_Rect &camera, bool toggleParticles, float scale = 1.0, float heightScale = 1.0);
+		void render(SDL_Rect &camera, float scale = 1.0, float heightScale = 1.0);
 		SDL_Rect dstrect = { 0, 0, CHARACTER_WIDTH, CHARACTER_HEIGHT };
 
 		bool isJumping;
@@ -82,48 +86,56 @@ class Character {
 			return mBox;
 		}
 
-		inline float getPosX() {
+		inline Real getPosX() {
 			return mPosX;
 		}
 
-		inline float getPosY() {
+		inline Real getPosY() {
 			return mPosY;
 		}
 
-		inline float getVelocityX() {
+		inline Real getVelocityX() {
 			return mVelX;
 		}
 
-		inline float getVelocityY() {
+		inline Real getVelocityY() {
 			return mVelY;
 		}
 
-		inline void setVelocityX(float velocity) {
+		inline void setVelocityX(Real velocity) {
 			mVelX = velocity;
 		}
 
-		inline void setVelocityY(float velocity) {
+		inline void setVelocityY(Real velocity) {
 			mVelY = velocity;
 		}
 
 
 	private:
 
-		// Particles.
-		Particle *particles[TOTAL_PARTICLES];
-
-		// Render particles.
-		void renderParticles(SDL_Rect &camera, bool toggleParticles);
-
 		//Collision box of the character
 		SDL_Rect mBox;
 
+		//Where the character is drawn
+		SDL_Rect mRenderBox;
+		Real mPrevPosX, mPrevPosY;
+
 		//Collision box of weapon.
 		SDL_Rect mWeapon;
-		float mPosX, mPosY;
+
+		//Animations the attacks are, and events of the set
+		int mAttack, mSecondAttack, mWalk;
+		int mAttackEvent, mTapEvent;
+
+		//Reads the attacks back from the animation
+		void readAnimation();
+
+		//Npcs under the weapon
+		std::vector<int> mWeaponHits;
+		Real mPosX, mPosY;
 
 		//The velocity of the character
-		float mVelX, mVelY;
+		Real mVelX, mVelY;
 };
 
 #endif
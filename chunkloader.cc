@@ -0,0 +1,85 @@
+#include "chunkloader.hpp"
+#include "globals.hpp"
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+ChunkLoader::ChunkLoader() {
+	mBusy = false;
+	mQuit = false;
+	mThread = std::thread(&ChunkLoader::loadLoop, this);
+}
+
+ChunkLoader::~ChunkLoader() {
+	{
+		std::lock_guard<std::mutex> guard(mLock);
+		mQuit = true;
+	}
+	mWake.notify_all();
+	mThread.join();
+}
+
+void ChunkLoader::request(int chunk, const MapTile *source, Tile *tiles) {
+	Request request = {chunk, source, tiles};
+	{
+		std::lock_guard<std::mutex> guard(mLock);
+		mRequests.push_back(request);
+	}
+	mWake.notify_one();
+}
+
+bool ChunkLoader::takeLoaded(int &chunk, Tile *&tiles) {
+	std::lock_guard<std::mutex> guard(mLock);
+	if(mLoaded.empty()) {
+		return false;
+	}
+	chunk = mLoaded.back().chunk;
+	tiles = mLoaded.back().tiles;
+	mLoaded.pop_back();
+	return true;
+}
+
+void ChunkLoader::wait() {
+	std::unique_lock<std::mutex> lock(mLock);
+	mIdle.wait(lock, [this] { return mRequests.empty() && !mBusy; });
+}
+
+void ChunkLoader::cancel() {
+	std::unique_lock<std::mutex> lock(mLock);
+	mRequests.clear();
+	mIdle.wait(lock, [this] { return !mBusy; });
+	mLoaded.clear();
+}
+
+void ChunkLoader::loadLoop() {
+	uintptr_t pageMask = ~((uintptr_t) sysconf(_SC_PAGESIZE) - 1);
+
+	std::unique_lock<std::mutex> lock(mLock);
+	for(;;) {
+		mWake.wait(lock, [this] { return mQuit || !mRequests.empty(); });
+		if(mQuit) {
+			return;
+		}
+		Request request = mRequests.front();
+		mRequests.pop_front();
+		mBusy = true;
+		lock.unlock();
+
+		//Reading the records faults the file in here
+		//Flags come from the type table rather than the file, and a type past it is left empty
+		for(int i = 0; i < LEVEL_CHUNK_TILES; ++i) {
+			int type = request.source[i].type;
+			request.tiles[i] = Tile(type < TOTAL_TILE_SPRITES ? type : 0);
+		}
+
+		//The game reads the copy, so the file pages can go
+		uintptr_t begin = (uintptr_t) request.source & pageMask;
+		uintptr_t end = (uintptr_t) (request.source + LEVEL_CHUNK_TILES);
+		madvise((void *) begin, end - begin, MADV_DONTNEED);
+
+		lock.lock();
+		mBusy = false;
+		mLoaded.push_back(request);
+		mIdle.notify_all();
+	}
+}
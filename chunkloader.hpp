@@ -0,0 +1,54 @@
+#ifndef CHUNKLOADER_HPP
+	#define CHUNKLOADER_HPP
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "tiles.hpp"
+#include "mapformat.hpp"
+
+//Copies level chunks out of a mapped level file on a background thread, so page faults never stall a frame
+class ChunkLoader {
+	public:
+		//Starts the loader thread
+		ChunkLoader();
+
+		//Stops the loader thread
+		~ChunkLoader();
+
+		//Queues a chunk to be copied from its file records into tiles
+		void request(int chunk, const MapTile *source, Tile *tiles);
+
+		//Takes a copied chunk, returns false if none are ready
+		bool takeLoaded(int &chunk, Tile *&tiles);
+
+		//Waits until every queued chunk is copied
+		void wait();
+
+		//Drops queued and copied chunks and waits for the one being copied
+		void cancel();
+
+	private:
+		struct Request {
+			int chunk;
+			const MapTile *source;
+			Tile *tiles;
+		};
+
+		//Copies chunks until told to quit
+		void loadLoop();
+
+		std::thread mThread;
+		std::mutex mLock;
+		std::condition_variable mWake;
+		std::condition_variable mIdle;
+
+		std::deque<Request> mRequests;
+		std::vector<Request> mLoaded;
+
+		//A chunk is being copied
+		bool mBusy;
+		bool mQuit;
+};
+#endif
@@ -0,0 +1,79 @@
+#ifndef FIXED_HPP
+	#define FIXED_HPP
+#include <SDL.h>
+#include <cmath>
+
+//Number with 16 fraction bits, its arithmetic is exact integer math and the same on every machine
+//Converts implicitly from int and float but only explicitly back, so mixed expressions stay fixed point
+class Fixed {
+	public:
+		static const int FRACTION_BITS = 16;
+
+		Fixed() : mRaw(0) {}
+		Fixed(int value) : mRaw((Sint64) value * ONE) {}
+
+		//Rounds to the nearest step, exact since scaling by a power of two loses nothing in a double
+		Fixed(float value) : mRaw(llround((double) value * ONE)) {}
+
+		//Truncates towards zero like a float
+		explicit operator int() const {
+			return (int) (mRaw / ONE);
+		}
+
+		explicit operator float() const {
+			return (float) ((double) mRaw / ONE);
+		}
+
+		Fixed &operator+=(Fixed other) {
+			mRaw += other.mRaw;
+			return *this;
+		}
+
+		Fixed &operator-=(Fixed other) {
+			mRaw -= other.mRaw;
+			return *this;
+		}
+
+		friend Fixed operator+(Fixed a, Fixed b) {
+			return fromRaw(a.mRaw + b.mRaw);
+		}
+
+		friend Fixed operator-(Fixed a, Fixed b) {
+			return fromRaw(a.mRaw - b.mRaw);
+		}
+
+		friend Fixed operator-(Fixed a) {
+			return fromRaw(-a.mRaw);
+		}
+
+		//Rounds towards negative infinity, fine for pixels up to about 2^31
+		friend Fixed operator*(Fixed a, Fixed b) {
+			return fromRaw((a.mRaw * b.mRaw) >> FRACTION_BITS);
+		}
+
+		friend bool operator<(Fixed a, Fixed b) { return a.mRaw < b.mRaw; }
+		friend bool operator>(Fixed a, Fixed b) { return a.mRaw > b.mRaw; }
+		friend bool operator<=(Fixed a, Fixed b) { return a.mRaw <= b.mRaw; }
+		friend bool operator>=(Fixed a, Fixed b) { return a.mRaw >= b.mRaw; }
+		friend bool operator==(Fixed a, Fixed b) { return a.mRaw == b.mRaw; }
+		friend bool operator!=(Fixed a, Fixed b) { return a.mRaw != b.mRaw; }
+
+	private:
+		static const Sint64 ONE = (Sint64) 1 << FRACTION_BITS;
+
+		static Fixed fromRaw(Sint64 raw) {
+			Fixed value;
+			value.mRaw = raw;
+			return value;
+		}
+
+		Sint64 mRaw;
+};
+
+//Positions and velocities of the simulation, fixed point when built with FIXED_POINT
+#ifdef FIXED_POINT
+	typedef Fixed Real;
+#else
+	typedef float Real;
+#endif
+#endif
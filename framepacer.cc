@@ -0,0 +1,79 @@
+#include "framepacer.hpp"
+#include "globals.hpp"
+
+FramePacer::FramePacer() {
+	mFrequency = SDL_GetPerformanceFrequency();
+	mRate = 0;
+	mWaits = false;
+	mPeriod = 0;
+	mDeadline = 0;
+	mLastFrame = 0;
+	mFrames = 0;
+	mMissedFrames = 0;
+}
+
+void FramePacer::setTargetRate(double rate, bool waits) {
+	mRate = rate > 0 ? rate : 0;
+	mWaits = waits;
+	mPeriod = mRate > 0 ? (Uint64) (mFrequency / mRate) : 0;
+	mDeadline = 0;
+	mLastFrame = 0;
+}
+
+void FramePacer::wait() {
+	++mFrames;
+	Uint64 now = SDL_GetPerformanceCounter();
+	if(mPeriod == 0) {
+		mLastFrame = now;
+		return;
+	}
+
+	//Vsync blocked in present, a frame that took over one and a half refreshes missed its vblank
+	if(!mWaits) {
+		if(mLastFrame != 0 && now - mLastFrame > mPeriod + mPeriod / 2) {
+			++mMissedFrames;
+		}
+		mLastFrame = now;
+		return;
+	}
+
+	//Late frames start the schedule over instead of rushing the next ones to catch up
+	if(mDeadline == 0 || now > mDeadline) {
+		if(mDeadline != 0) {
+			++mMissedFrames;
+		}
+		mDeadline = now + mPeriod;
+		mLastFrame = now;
+		return;
+	}
+
+	//Sleep in whole milliseconds while the deadline is far, the scheduler can oversleep by about one
+	Uint64 spin = (Uint64) (FRAME_SPIN_TIME * mFrequency);
+	while(mDeadline - now > spin) {
+		Uint32 sleep = (Uint32) ((mDeadline - now - spin) * 1000 / mFrequency);
+		if(sleep == 0) {
+			break;
+		}
+		SDL_Delay(sleep);
+		now = SDL_GetPerformanceCounter();
+		if(now >= mDeadline) {
+			break;
+		}
+	}
+
+	//Spin the rest
+	while(now < mDeadline) {
+		now = SDL_GetPerformanceCounter();
+	}
+
+	mLastFrame = now;
+	mDeadline += mPeriod;
+}
+
+int FramePacer::getFrames() {
+	return mFrames;
+}
+
+int FramePacer::getMissedFrames() {
+	return mMissedFrames;
+}
@@ -0,0 +1,42 @@
+#ifndef FRAMEPACER_HPP
+	#define FRAMEPACER_HPP
+#include <SDL.h>
+
+//Holds frames to a target rate, sleeping while a frame is far off and spinning the last stretch
+//When vsync paces the frames it only watches for missed ones
+class FramePacer {
+	public:
+		//Starts uncapped
+		FramePacer();
+
+		//Sets frames per second, 0 for uncapped, waits is false when something else holds the rate
+		void setTargetRate(double rate, bool waits);
+
+		inline double getTargetRate() {
+			return mRate;
+		}
+
+		//Waits until the next frame is due, call once a frame after presenting
+		void wait();
+
+		//Frames paced so far, and those that came later than due
+		int getFrames();
+		int getMissedFrames();
+
+	private:
+		Uint64 mFrequency;
+
+		double mRate;
+		bool mWaits;
+
+		//Performance counter ticks per frame, 0 when uncapped
+		Uint64 mPeriod;
+
+		//When the next frame is due, and when the last one was done
+		Uint64 mDeadline;
+		Uint64 mLastFrame;
+
+		int mFrames;
+		int mMissedFrames;
+};
+#endif
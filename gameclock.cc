@@ -0,0 +1,45 @@
+#include "gameclock.hpp"
+
+GameClock::GameClock() {
+	mCounter = 0;
+	mFrequency = 0;
+	mTime = 0;
+	mFrameTime = 0;
+	mRealTime = 0;
+	mTimeScale = 1;
+	mPaused = false;
+}
+
+void GameClock::tick() {
+	if(mFrequency == 0) {
+		mFrequency = SDL_GetPerformanceFrequency();
+	}
+
+	//Nothing has passed before the first sample
+	Uint64 counter = SDL_GetPerformanceCounter();
+	double seconds = mCounter != 0 ? (counter - mCounter) / (double) mFrequency : 0;
+	mCounter = counter;
+	advance(seconds);
+}
+
+void GameClock::advance(double seconds) {
+	mRealTime += seconds;
+	mFrameTime = mPaused ? 0 : seconds * mTimeScale;
+	mTime += mFrameTime;
+}
+
+void GameClock::setPaused(bool paused) {
+	mPaused = paused;
+}
+
+bool GameClock::isPaused() {
+	return mPaused;
+}
+
+void GameClock::setTimeScale(double scale) {
+	mTimeScale = scale;
+}
+
+double GameClock::getTimeScale() {
+	return mTimeScale;
+}
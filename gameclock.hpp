@@ -0,0 +1,58 @@
+#ifndef GAMECLOCK_HPP
+	#define GAMECLOCK_HPP
+#include <SDL.h>
+
+//Game time from the performance counter, sampled once a frame so every timer and animation sees the same time
+//Game time stops while paused and runs at the time scale, real time always runs
+class GameClock {
+	public:
+		//Initializes variables, the first sample starts the clock
+		GameClock();
+
+		//Samples the performance counter and advances by the real time since the last sample
+		void tick();
+
+		//Advances by a given real time without sampling, for runs driven by the simulation
+		void advance(double seconds);
+
+		//Game time in seconds and milliseconds, as of the last sample
+		inline double getTime() {
+			return mTime;
+		}
+
+		inline Uint32 getTicks() {
+			return (Uint32) (mTime * 1000);
+		}
+
+		//Game time between the last two samples
+		inline double getFrameTime() {
+			return mFrameTime;
+		}
+
+		//Real time in seconds, as of the last sample
+		inline double getRealTime() {
+			return mRealTime;
+		}
+
+		void setPaused(bool paused);
+		bool isPaused();
+
+		//How fast game time runs against real time
+		void setTimeScale(double scale);
+		double getTimeScale();
+
+	private:
+		//Counter at the last sample, 0 before the first
+		Uint64 mCounter;
+		Uint64 mFrequency;
+
+		double mTime;
+		double mFrameTime;
+		double mRealTime;
+
+		double mTimeScale;
+		bool mPaused;
+};
+
+extern GameClock gClock;
+#endif
@@ -0,0 +1,57 @@
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <SDL_mixer.h>
+#include "texture.hpp"
+#include "texturecache.hpp"
+#include "button.hpp"
+#include "logger.hpp"
+#include "profiler.hpp"
+#include "gameclock.hpp"
+#include "animation.hpp"
+#include "globals.hpp"
+
+//The window we'll be rendering to
+SDL_Window *gWindow;
+
+//The window renderer
+SDL_Renderer *gRenderer; 
+
+// Globally used font.
+TTF_Font *gFont = NULL;
+
+float gScale;
+int gSimulationRate = DEFAULT_SIMULATION_RATE;
+int gFrameRate = DEFAULT_FRAME_RATE;
+
+// Running the simulation alone, with no window and nothing loaded to draw.
+bool gHeadless = false;
+
+//Sprite sheets shared between npcs
+TextureCache gTextureCache;
+
+LTexture gButtonSpriteSheetTexture;
+LButton gButtons[TOTAL_BUTTONS];
+SDL_Rect gSpriteClips[BUTTON_SPRITE_TOTAL];
+
+//Scene textures
+LTexture gTileTexture;
+SDL_Rect gTileClips[TOTAL_TILE_SPRITES];
+
+LTexture gRedTexture;
+LTexture gGreenTexture;
+LTexture gBlueTexture;
+LTexture gShimmerTexture;
+
+Mix_Music *gMusic[4];
+
+// Log written by a background thread.
+Logger gLogger;
+
+// Frame zones of every thread.
+Profiler gProfiler;
+
+// Game time, sampled once a frame.
+GameClock gClock;
+
+// Animation sets of every sheet.
+AnimationLibrary gAnimations;
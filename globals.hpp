@@ -10,32 +10,95 @@
 class LTexture;
 class LButton;
 class Npc;
+class TextureCache;
+class SpatialHash;
 
 const int SCREEN_WIDTH = 1024;
 const int SCREEN_HEIGHT = 768;
 
-//The dimensions of the level
-const int LEVEL_WIDTH = 1280 * 2;
-const int LEVEL_HEIGHT = 960 * 2;
+// Frame rate targets, any other value is frames per second.
+const int FRAME_RATE_UNCAPPED = 0;
+const int FRAME_RATE_DISPLAY = -1;
 
-// Frame rate cap.
-const int SCREEN_FPS = 60;
-const int SCREEN_TICKS_PER_FRAME = 1000 / SCREEN_FPS;
+// Frame rate unless config.txt or the command line sets one, synced to the display.
+const int DEFAULT_FRAME_RATE = FRAME_RATE_DISPLAY;
+
+// Refresh rate assumed when the display does not report one.
+const int DEFAULT_REFRESH_RATE = 60;
+
+// Time before a frame is due that the pacer spins instead of sleeping, in seconds.
+const double FRAME_SPIN_TIME = 0.001;
+
+// Time the loading screen spends uploading between redraws, in milliseconds.
+const Uint32 LOADING_UPLOAD_TIME = 8;
+
+// Simulation steps per second, unless config.txt sets one.
+const int DEFAULT_SIMULATION_RATE = 60;
+
+// Longest frame the simulation catches up on, in seconds.
+const float MAX_FRAME_TIME = 0.25f;
+
+// Slowest and fastest game time runs against real time.
+const double MIN_TIME_SCALE = 0.125;
+const double MAX_TIME_SCALE = 4;
+
+// Fewest threads decoding files at startup.
+const int MIN_ASSET_WORKERS = 4;
 
 //Tile constants
 const int TILE_WIDTH = 80;
 const int TILE_HEIGHT = 80;
-const int TOTAL_TILES = (192 * 2) * 2;
 const int TOTAL_TILE_SPRITES = 96;
 
+// Size of the pre-rendered pieces of the tile layer.
+const int TILE_LAYER_WIDTH = 512;
+const int TILE_LAYER_HEIGHT = 512;
+
+// Levels are stored in square chunks of tiles, a power of two on a side.
+const int LEVEL_CHUNK_SHIFT = 5;
+const int LEVEL_CHUNK_SIZE = 1 << LEVEL_CHUNK_SHIFT;
+const int LEVEL_CHUNK_TILES = LEVEL_CHUNK_SIZE * LEVEL_CHUNK_SIZE;
+
+// Chunks kept loaded around the camera, and the most loaded at once.
+const int LEVEL_STREAM_MARGIN = 1;
+const int MAX_LOADED_CHUNKS = 32;
+
+// Largest level side in tiles.
+const int MAX_LEVEL_TILES = 16384;
+
+// Size of levels from text maps, which do not say how big they are.
+const int DEFAULT_LEVEL_COLUMNS = 32;
+const int DEFAULT_LEVEL_ROWS = 24;
+
 //The different tile sprites
 const int TILESHEET_WIDTH = 640;
 const int TILESHEET_HEIGHT = 960;
 
-const int TOTAL_PARTICLES = 15;
+// Particle constants.
+const int MAX_PARTICLES = 32768;
+const int PARTICLE_FRAMES = 10;
+const float CHARACTER_PARTICLE_RATE = 100;
+const int NPC_HIT_PARTICLES = 20;
+const int TAP_PARTICLES = 10;
+
+// Frames the profiler overlay averages over, and frames in a captured trace.
+const int PROFILE_AVERAGE_FRAMES = 60;
+const int PROFILE_TRACE_FRAMES = 300;
+
+// Glyphs kept in the text atlas, printable ascii.
+const int FIRST_GLYPH = 32;
+const int TOTAL_GLYPHS = 95;
+const int GLYPH_ATLAS_WIDTH = 512;
 
 const int TOTAL_NPCS = 100;
 
+// Npcs a level starts with in the game, and seconds of simulated time between npc thinks.
+const int LEVEL_NPCS = 5;
+const int NPC_THINK_TIME = 2;
+
+// Seconds of simulated time a stabbed npc is pushed back for.
+const float NPC_RECOVERY_TIME = 0.1f;
+
 // Button constants.
 const int BUTTON_WIDTH = 300;
 const int BUTTON_HEIGHT = 200;
@@ -63,9 +126,12 @@ extern LTexture gButtonSpriteSheetTexture;
 extern LButton gButtons[TOTAL_BUTTONS];
 extern SDL_Rect gSpriteClips[4];
 
-extern void log(std::string message);
-extern int touchesNpc(SDL_Rect box, std::vector<Npc *> &npcContainer);
+extern int touchesNpc(SDL_Rect box, SpatialHash &npcHash);
 extern Mix_Music *gMusic[4];
 extern float gScale;
+extern int gSimulationRate;
+extern int gFrameRate;
+extern bool gHeadless;
+extern TextureCache gTextureCache;
 
 #endif
@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include "glyphatlas.hpp"
+
+//Glyph index of a character, -1 if it is not in the atlas
+static int glyphIndex(char c) {
+	int index = (unsigned char) c - FIRST_GLYPH;
+	return (index >= 0 && index < TOTAL_GLYPHS) ? index : -1;
+}
+
+GlyphAtlas::GlyphAtlas() {
+	//Initialize
+	mTexture = NULL;
+	mHeight = 0;
+	for(int i = 0; i < TOTAL_GLYPHS; ++i) {
+		mGlyphs[i].x = 0;
+		mGlyphs[i].y = 0;
+		mGlyphs[i].w = 0;
+		mGlyphs[i].h = 0;
+	}
+}
+
+GlyphAtlas::~GlyphAtlas() {
+	//Deallocate
+	free();
+}
+
+bool GlyphAtlas::loadFromFont(TTF_Font *font) {
+	//Get rid of preexisting atlas
+	free();
+
+	//Render every glyph in white, color comes from modulation when drawing
+	SDL_Color white = {0xFF, 0xFF, 0xFF};
+	SDL_Surface *glyphSurfaces[TOTAL_GLYPHS];
+	int x = 0;
+	int y = 0;
+	bool success = true;
+	for(int i = 0; i < TOTAL_GLYPHS; ++i) {
+		//Rendered as text so glyphs keep the line's baseline
+		char text[2] = {(char) (FIRST_GLYPH + i), '\0'};
+		glyphSurfaces[i] = TTF_RenderText_Solid(font, text, white);
+		if(glyphSurfaces[i] == NULL) {
+			printf("Unable to render glyph %d! SDL_ttf Error: %s\n", FIRST_GLYPH + i, TTF_GetError());
+			success = false;
+			continue;
+		}
+
+		//Wrap to the next row of the atlas
+		if(x + glyphSurfaces[i]->w > GLYPH_ATLAS_WIDTH) {
+			x = 0;
+			y += mHeight;
+		}
+		mGlyphs[i].x = x;
+		mGlyphs[i].y = y;
+		mGlyphs[i].w = glyphSurfaces[i]->w;
+		mGlyphs[i].h = glyphSurfaces[i]->h;
+		x += glyphSurfaces[i]->w;
+		if(glyphSurfaces[i]->h > mHeight) mHeight = glyphSurfaces[i]->h;
+	}
+
+	//Pack the glyphs into one surface and upload it once
+	SDL_Surface *atlasSurface = NULL;
+	if(success) {
+		atlasSurface = SDL_CreateRGBSurfaceWithFormat(0, GLYPH_ATLAS_WIDTH, y + mHeight, 32, SDL_PIXELFORMAT_RGBA8888);
+		if(atlasSurface == NULL) {
+			printf("Unable to create glyph atlas! SDL Error: %s\n", SDL_GetError());
+			success = false;
+		}
+	}
+	for(int i = 0; i < TOTAL_GLYPHS; ++i) {
+		if(glyphSurfaces[i] != NULL) {
+			if(atlasSurface != NULL) {
+				SDL_BlitSurface(glyphSurfaces[i], NULL, atlasSurface, &mGlyphs[i]);
+			}
+			SDL_FreeSurface(glyphSurfaces[i]);
+		}
+	}
+	if(atlasSurface != NULL) {
+		mTexture = SDL_CreateTextureFromSurface(gRenderer, atlasSurface);
+		if(mTexture == NULL) {
+			printf("Unable to create texture from glyph atlas! SDL Error: %s\n", SDL_GetError());
+		}
+		SDL_FreeSurface(atlasSurface);
+	}
+
+	//Return success
+	return mTexture != NULL;
+}
+
+void GlyphAtlas::free() {
+	//Free texture if it exists
+	if(mTexture != NULL) {
+		SDL_DestroyTexture(mTexture);
+		mTexture = NULL;
+	}
+	mHeight = 0;
+}
+
+void GlyphAtlas::render(int x, int y, const char *text, SDL_Color color) {
+	if(mTexture == NULL) {
+		return;
+	}
+
+	//Color the whole string at once
+	SDL_SetTextureColorMod(mTexture, color.r, color.g, color.b);
+
+	SDL_Rect renderQuad = {x, y, 0, 0};
+	for(; *text != '\0'; ++text) {
+		int index = glyphIndex(*text);
+		if(index < 0) {
+			continue;
+		}
+		renderQuad.w = mGlyphs[index].w;
+		renderQuad.h = mGlyphs[index].h;
+		SDL_RenderCopy(gRenderer, mTexture, &mGlyphs[index], &renderQuad);
+		renderQuad.x += mGlyphs[index].w;
+	}
+}
+
+int GlyphAtlas::getWidth(const char *text) {
+	int width = 0;
+	for(; *text != '\0'; ++text) {
+		int index = glyphIndex(*text);
+		if(index >= 0) {
+			width += mGlyphs[index].w;
+		}
+	}
+	return width;
+}
+
+int GlyphAtlas::getHeight() {
+	return mHeight;
+}
@@ -0,0 +1,39 @@
+#ifndef GLYPHATLAS_HPP
+	#define GLYPHATLAS_HPP
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include "globals.hpp"
+
+//Printable ascii glyphs of a font packed into one texture, text is drawn one copy per glyph
+class GlyphAtlas {
+	public:
+		//Initializes variables
+		GlyphAtlas();
+
+		//Deallocates memory
+		~GlyphAtlas();
+
+		//Renders every glyph of the font into the atlas
+		bool loadFromFont(TTF_Font *font);
+
+		//Deallocates the atlas
+		void free();
+
+		//Renders text at given point, glyphs outside the atlas are skipped
+		void render(int x, int y, const char *text, SDL_Color color);
+
+		//Gets text dimensions
+		int getWidth(const char *text);
+		int getHeight();
+
+	private:
+		//The actual hardware texture
+		SDL_Texture *mTexture;
+
+		//Where each glyph sits in the atlas
+		SDL_Rect mGlyphs[TOTAL_GLYPHS];
+
+		//Line height
+		int mHeight;
+};
+#endif
@@ -0,0 +1,155 @@
+#include "inputlog.hpp"
+#include <string.h>
+
+InputLog::InputLog() {
+	mFile = NULL;
+	memset(&mHeader, 0, sizeof(mHeader));
+	mNext = 0;
+	mReplaying = false;
+}
+
+InputLog::~InputLog() {
+	close();
+}
+
+bool InputLog::record(std::string path, Uint32 seed, int simulationRate) {
+	close();
+
+	memcpy(mHeader.magic, INPUT_MAGIC, sizeof(INPUT_MAGIC));
+	mHeader.version = INPUT_VERSION;
+	mHeader.seed = seed;
+	mHeader.simulationRate = simulationRate;
+
+	mFile = fopen(path.c_str(), "wb");
+	if(mFile == NULL) {
+		printf("Unable to create input file %s!\n", path.c_str());
+		return false;
+	}
+	if(fwrite(&mHeader, sizeof(mHeader), 1, mFile) != 1) {
+		printf("Unable to write input file %s!\n", path.c_str());
+		close();
+		return false;
+	}
+	return true;
+}
+
+bool InputLog::replay(std::string path) {
+	close();
+
+	FILE *file = fopen(path.c_str(), "rb");
+	if(file == NULL) {
+		printf("Unable to open input file %s!\n", path.c_str());
+		return false;
+	}
+
+	bool success = true;
+	if(fread(&mHeader, sizeof(mHeader), 1, file) != 1 || memcmp(mHeader.magic, INPUT_MAGIC, sizeof(INPUT_MAGIC)) != 0 || mHeader.simulationRate == 0) {
+		printf("%s is not an input file!\n", path.c_str());
+		success = false;
+	}
+	else if(mHeader.version != INPUT_VERSION) {
+		printf("Input file %s has version %u, expected %u!\n", path.c_str(), mHeader.version, INPUT_VERSION);
+		success = false;
+	}
+	else {
+		//A run cut short can leave half a record at the end, drop it
+		InputRecord record;
+		while(fread(&record, sizeof(record), 1, file) == 1) {
+			mRecords.push_back(record);
+		}
+		mNext = 0;
+		mReplaying = true;
+	}
+	fclose(file);
+	return success;
+}
+
+void InputLog::close() {
+	if(mFile != NULL) {
+		fclose(mFile);
+		mFile = NULL;
+	}
+	mRecords.clear();
+	mNext = 0;
+	mReplaying = false;
+}
+
+bool InputLog::isRecording() {
+	return mFile != NULL;
+}
+
+bool InputLog::isReplaying() {
+	return mReplaying;
+}
+
+Uint32 InputLog::getSeed() {
+	return mHeader.seed;
+}
+
+int InputLog::getSimulationRate() {
+	return mHeader.simulationRate;
+}
+
+void InputLog::write(Uint32 tick, const SDL_Event &e, int x, int y) {
+	if(mFile == NULL) {
+		return;
+	}
+
+	InputRecord record;
+	memset(&record, 0, sizeof(record));
+	record.tick = tick;
+	record.type = e.type;
+	switch(e.type) {
+		case SDL_QUIT:
+			break;
+		case SDL_KEYDOWN:
+		case SDL_KEYUP:
+			record.code = e.key.keysym.sym;
+			record.repeat = e.key.repeat;
+			break;
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP:
+			record.code = e.button.button;
+			record.repeat = e.button.clicks;
+			record.x = x;
+			record.y = y;
+			break;
+		default:
+			return;
+	}
+	fwrite(&record, sizeof(record), 1, mFile);
+}
+
+bool InputLog::read(Uint32 tick, SDL_Event &e, int &x, int &y) {
+	if(mNext >= mRecords.size() || mRecords[mNext].tick > tick) {
+		return false;
+	}
+	const InputRecord &record = mRecords[mNext++];
+
+	memset(&e, 0, sizeof(e));
+	e.type = record.type;
+	x = record.x;
+	y = record.y;
+	switch(record.type) {
+		case SDL_KEYDOWN:
+		case SDL_KEYUP:
+			e.key.state = record.type == SDL_KEYDOWN ? SDL_PRESSED : SDL_RELEASED;
+			e.key.repeat = record.repeat;
+			e.key.keysym.sym = record.code;
+			e.key.keysym.scancode = SDL_GetScancodeFromKey(record.code);
+			break;
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP:
+			e.button.state = record.type == SDL_MOUSEBUTTONDOWN ? SDL_PRESSED : SDL_RELEASED;
+			e.button.button = record.code;
+			e.button.clicks = record.repeat;
+			break;
+		default:
+			break;
+	}
+	return true;
+}
+
+bool InputLog::isFinished() {
+	return mNext >= mRecords.size();
+}
@@ -0,0 +1,84 @@
+#ifndef INPUTLOG_HPP
+	#define INPUTLOG_HPP
+#include <SDL.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+//Input files, a header then one record per event in the order it was given, all little endian
+const char INPUT_MAGIC[4] = {'I', 'N', 'P', 'T'};
+const Uint32 INPUT_VERSION = 1;
+
+struct InputHeader {
+	char magic[4];
+	Uint32 version;
+
+	//What the run has to start with to play out the same
+	Uint32 seed;
+	Uint32 simulationRate;
+};
+
+//One key or mouse button event
+struct InputRecord {
+	//Simulation step the event was given before
+	Uint32 tick;
+
+	//SDL_QUIT, SDL_KEYDOWN, SDL_KEYUP, SDL_MOUSEBUTTONDOWN or SDL_MOUSEBUTTONUP
+	Uint32 type;
+
+	//Key code, or mouse button
+	Sint32 code;
+
+	//Key repeat, or mouse clicks
+	Uint8 repeat;
+	Uint8 unused[3];
+
+	//Level position of mouse events
+	Sint32 x, y;
+};
+
+//Records the input the world reacts to with the step it came before, and feeds it back on a later run
+class InputLog {
+	public:
+		//Initializes variables
+		InputLog();
+
+		//Closes the file
+		~InputLog();
+
+		//Starts writing events to a file
+		bool record(std::string path, Uint32 seed, int simulationRate);
+
+		//Reads a recorded file whole to feed it back
+		bool replay(std::string path);
+
+		//Finishes the file being written
+		void close();
+
+		bool isRecording();
+		bool isReplaying();
+
+		//Settings the recorded run started with
+		Uint32 getSeed();
+		int getSimulationRate();
+
+		//Writes a key, mouse button or quit event, mouse events at their level position
+		//Other events are not recorded
+		void write(Uint32 tick, const SDL_Event &e, int x, int y);
+
+		//Takes the next event recorded before a step with its level position, false when none is left for it
+		bool read(Uint32 tick, SDL_Event &e, int &x, int &y);
+
+		//Every recorded event was read
+		bool isFinished();
+
+	private:
+		FILE *mFile;
+		InputHeader mHeader;
+
+		//Events being fed back, and the next one to read
+		std::vector<InputRecord> mRecords;
+		unsigned int mNext;
+		bool mReplaying;
+};
+#endif
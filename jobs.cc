@@ -0,0 +1,129 @@
+#include "jobs.hpp"
+
+JobSystem::JobSystem(int totalWorkers) {
+	if(totalWorkers < 0) {
+		totalWorkers = (int) std::thread::hardware_concurrency() - 1;
+		if(totalWorkers < 0) totalWorkers = 0;
+	}
+
+	mJob = NULL;
+	mPending = 0;
+	mGeneration = 0;
+	mQuit = false;
+
+	for(int i = 0; i <= totalWorkers; ++i) {
+		mQueues.push_back(new Queue());
+	}
+	for(int i = 1; i <= totalWorkers; ++i) {
+		mWorkers.push_back(std::thread(&JobSystem::workerLoop, this, i));
+	}
+}
+
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> guard(mWakeLock);
+		mQuit = true;
+	}
+	mWake.notify_all();
+
+	for(unsigned i = 0; i < mWorkers.size(); ++i) {
+		mWorkers[i].join();
+	}
+	for(unsigned i = 0; i < mQueues.size(); ++i) {
+		delete mQueues[i];
+	}
+}
+
+void JobSystem::parallelFor(int count, int grain, const std::function<void(int, int)> &job) {
+	if(grain < 1) grain = 1;
+
+	//Not worth waking anyone for
+	if(mWorkers.empty() || count <= grain) {
+		if(count > 0) job(0, count);
+		return;
+	}
+
+	//Deal the chunks out round robin, the job is visible to whoever pops them
+	mJob = &job;
+	int chunks = 0;
+	for(int begin = 0; begin < count; begin += grain) {
+		Chunk chunk = {begin, begin + grain < count ? begin + grain : count};
+		Queue *queue = mQueues[chunks % mQueues.size()];
+		std::lock_guard<std::mutex> guard(queue->lock);
+		queue->chunks.push_back(chunk);
+		++chunks;
+	}
+	mPending += chunks;
+
+	{
+		std::lock_guard<std::mutex> guard(mWakeLock);
+		++mGeneration;
+	}
+	mWake.notify_all();
+
+	//Help out, then wait for chunks still running elsewhere
+	while(runChunk(0)) {
+	}
+	std::unique_lock<std::mutex> guard(mWakeLock);
+	while(mPending > 0) {
+		mDone.wait(guard);
+	}
+	mJob = NULL;
+}
+
+int JobSystem::getTotalThreads() {
+	return (int) mQueues.size();
+}
+
+bool JobSystem::runChunk(int queue) {
+	Chunk chunk;
+	bool found = false;
+
+	//Newest chunk from our own queue first, then the oldest from the others
+	for(unsigned i = 0; i < mQueues.size() && !found; ++i) {
+		Queue *victim = mQueues[(queue + i) % mQueues.size()];
+		std::lock_guard<std::mutex> guard(victim->lock);
+		if(!victim->chunks.empty()) {
+			if(i == 0) {
+				chunk = victim->chunks.back();
+				victim->chunks.pop_back();
+			}
+			else {
+				chunk = victim->chunks.front();
+				victim->chunks.pop_front();
+			}
+			found = true;
+		}
+	}
+	if(!found) {
+		return false;
+	}
+
+	(*mJob)(chunk.begin, chunk.end);
+
+	//Last chunk out wakes the caller
+	if(--mPending == 0) {
+		std::lock_guard<std::mutex> guard(mWakeLock);
+		mDone.notify_all();
+	}
+	return true;
+}
+
+void JobSystem::workerLoop(int queue) {
+	unsigned generation = 0;
+	while(true) {
+		{
+			std::unique_lock<std::mutex> guard(mWakeLock);
+			while(!mQuit && generation == mGeneration) {
+				mWake.wait(guard);
+			}
+			if(mQuit) {
+				return;
+			}
+			generation = mGeneration;
+		}
+
+		while(runChunk(queue)) {
+		}
+	}
+}
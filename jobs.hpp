@@ -0,0 +1,63 @@
+#ifndef JOBS_HPP
+	#define JOBS_HPP
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+//Thread pool that splits loops into chunks, idle threads steal chunks from busy ones
+class JobSystem {
+	public:
+		//Starts the workers, by default one per core besides the calling thread
+		JobSystem(int totalWorkers = -1);
+
+		//Stops the workers
+		~JobSystem();
+
+		//Calls job(begin, end) over [0, count) in chunks of grain, returns once all chunks ran
+		//The calling thread helps, jobs must not call parallelFor themselves
+		void parallelFor(int count, int grain, const std::function<void(int, int)> &job);
+
+		//Worker threads plus the calling thread
+		int getTotalThreads();
+
+	private:
+		struct Chunk {
+			int begin;
+			int end;
+		};
+
+		//Chunks waiting for a thread, owners pop the back and thieves take the front
+		struct Queue {
+			std::mutex lock;
+			std::deque<Chunk> chunks;
+		};
+
+		//Waits for work and runs it until told to quit
+		void workerLoop(int queue);
+
+		//Runs one chunk from our own queue or stolen from another, false if there was none
+		bool runChunk(int queue);
+
+		std::vector<std::thread> mWorkers;
+
+		//One queue per thread, the calling thread uses the first
+		std::vector<Queue *> mQueues;
+
+		//The loop body of the current parallelFor
+		const std::function<void(int, int)> *mJob;
+
+		//Chunks not finished yet
+		std::atomic<int> mPending;
+
+		//Wakes workers when a loop starts, and the caller when it ends
+		std::mutex mWakeLock;
+		std::condition_variable mWake;
+		std::condition_variable mDone;
+		unsigned mGeneration;
+		bool mQuit;
+};
+#endif
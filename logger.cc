@@ -0,0 +1,140 @@
+#include "logger.hpp"
+#include <string.h>
+#include <chrono>
+
+static const char *gLevelNames[] = {"DEBUG", "INFO", "WARNING", "ERROR"};
+
+Logger::Logger() {
+	//Every slot starts free for the first lap
+	for(int i = 0; i < LOG_RING_SIZE; ++i) {
+		mRecords[i].sequence.store(i, std::memory_order_relaxed);
+	}
+	mHead.store(0);
+	mTail = 0;
+	mDropped.store(0);
+	mFile = NULL;
+	mBytes = 0;
+	mRunning.store(false);
+}
+
+Logger::~Logger() {
+	close();
+}
+
+bool Logger::open(std::string path) {
+	close();
+
+	mPath = path;
+	mFile = fopen(mPath.c_str(), "w");
+	if(mFile == NULL) {
+		printf("Unable to open log %s!\n", mPath.c_str());
+		return false;
+	}
+	mBytes = 0;
+
+	mRunning.store(true);
+	mThread = std::thread(&Logger::drainLoop, this);
+	return true;
+}
+
+void Logger::close() {
+	if(mThread.joinable()) {
+		mRunning.store(false);
+		mThread.join();
+	}
+
+	//Whatever was queued after the last batch
+	if(mFile != NULL) {
+		drain();
+		fclose(mFile);
+		mFile = NULL;
+	}
+}
+
+void Logger::write(int level, const char *message) {
+	//Claim a slot, a slot is free when its sequence matches the position
+	unsigned int position = mHead.load(std::memory_order_relaxed);
+	Record *record;
+	for(;;) {
+		record = &mRecords[position & (LOG_RING_SIZE - 1)];
+		int lap = (int) (record->sequence.load(std::memory_order_acquire) - position);
+		if(lap == 0) {
+			if(mHead.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		}
+		else if(lap < 0) {
+			//The writer is a whole ring behind
+			mDropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		else {
+			position = mHead.load(std::memory_order_relaxed);
+		}
+	}
+
+	record->level = level;
+	record->ticks = SDL_GetTicks();
+	strncpy(record->text, message, LOG_MESSAGE_SIZE - 1);
+	record->text[LOG_MESSAGE_SIZE - 1] = '\0';
+
+	//Hand the slot to the writer
+	record->sequence.store(position + 1, std::memory_order_release);
+}
+
+void Logger::write(int level, const std::string &message) {
+	write(level, message.c_str());
+}
+
+void Logger::drainLoop() {
+	while(mRunning.load()) {
+		drain();
+		std::this_thread::sleep_for(std::chrono::milliseconds(LOG_DRAIN_INTERVAL));
+	}
+}
+
+void Logger::drain() {
+	mBatch.clear();
+	char line[LOG_MESSAGE_SIZE + 32];
+
+	int dropped = mDropped.exchange(0, std::memory_order_relaxed);
+	if(dropped > 0) {
+		snprintf(line, sizeof(line), "[%u] WARNING %d messages dropped\n", SDL_GetTicks(), dropped);
+		mBatch += line;
+	}
+
+	for(;;) {
+		Record &record = mRecords[mTail & (LOG_RING_SIZE - 1)];
+		if(record.sequence.load(std::memory_order_acquire) != mTail + 1) {
+			break;
+		}
+		snprintf(line, sizeof(line), "[%u] %s %s\n", record.ticks, gLevelNames[record.level], record.text);
+		mBatch += line;
+
+		//Free the slot for the next lap
+		record.sequence.store(mTail + LOG_RING_SIZE, std::memory_order_release);
+		++mTail;
+	}
+
+	if(mBatch.empty()) {
+		return;
+	}
+	if(mBytes + (long) mBatch.size() > LOG_MAX_BYTES) {
+		rotate();
+	}
+	if(mFile != NULL) {
+		fwrite(mBatch.data(), 1, mBatch.size(), mFile);
+		fflush(mFile);
+		mBytes += mBatch.size();
+	}
+}
+
+void Logger::rotate() {
+	//Keep one old log next to the current one
+	std::string oldPath = mPath + ".1";
+	fclose(mFile);
+	remove(oldPath.c_str());
+	rename(mPath.c_str(), oldPath.c_str());
+	mFile = fopen(mPath.c_str(), "w");
+	mBytes = 0;
+}
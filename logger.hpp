@@ -0,0 +1,108 @@
+#ifndef LOGGER_HPP
+	#define LOGGER_HPP
+#include <SDL.h>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <atomic>
+
+//Message levels, messages below LOG_LEVEL are compiled out
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARNING 2
+#define LOG_LEVEL_ERROR 3
+
+#ifndef LOG_LEVEL
+	#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+//Longest message kept, longer ones are cut
+const int LOG_MESSAGE_SIZE = 120;
+
+//Messages the ring holds before dropping, a power of two
+const int LOG_RING_SIZE = 1024;
+
+//How often the writer thread empties the ring, in milliseconds
+const int LOG_DRAIN_INTERVAL = 10;
+
+//Size the log reaches before it is moved aside
+const long LOG_MAX_BYTES = 1024 * 1024;
+
+//Logger where any thread pushes messages into a lock-free ring and a writer thread saves them in batches
+class Logger {
+	public:
+		//Initializes variables
+		Logger();
+
+		//Stops the writer thread
+		~Logger();
+
+		//Opens the log file and starts the writer thread
+		bool open(std::string path);
+
+		//Writes what is left and closes the file
+		void close();
+
+		//Queues a message, dropped if the ring is full
+		void write(int level, const char *message);
+		void write(int level, const std::string &message);
+
+	private:
+		struct Record {
+			//Which lap of the ring the record belongs to
+			std::atomic<unsigned int> sequence;
+
+			int level;
+			Uint32 ticks;
+			char text[LOG_MESSAGE_SIZE];
+		};
+
+		//Writer thread, drains the ring until closed
+		void drainLoop();
+
+		//Writes every queued message in one batch
+		void drain();
+
+		//Moves a full log aside and starts a new one
+		void rotate();
+
+		Record mRecords[LOG_RING_SIZE];
+
+		//Next slot for producers, next slot for the writer
+		std::atomic<unsigned int> mHead;
+		unsigned int mTail;
+
+		//Messages lost to a full ring
+		std::atomic<int> mDropped;
+
+		std::string mPath;
+		FILE *mFile;
+		long mBytes;
+		std::string mBatch;
+
+		std::thread mThread;
+		std::atomic<bool> mRunning;
+};
+
+extern Logger gLogger;
+
+#if LOG_LEVEL <= LOG_LEVEL_DEBUG
+	#define LOG_DEBUG(message) gLogger.write(LOG_LEVEL_DEBUG, message)
+#else
+	#define LOG_DEBUG(message) ((void) 0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_INFO
+	#define LOG_INFO(message) gLogger.write(LOG_LEVEL_INFO, message)
+#else
+	#define LOG_INFO(message) ((void) 0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_WARNING
+	#define LOG_WARNING(message) gLogger.write(LOG_LEVEL_WARNING, message)
+#else
+	#define LOG_WARNING(message) ((void) 0)
+#endif
+
+#define LOG_ERROR(message) gLogger.write(LOG_LEVEL_ERROR, message)
+#endif
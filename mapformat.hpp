@@ -0,0 +1,41 @@
+#ifndef MAPFORMAT_HPP
+	#define MAPFORMAT_HPP
+#include <SDL.h>
+
+//Compiled level files, written by tools/mapc and mapped straight into memory by the game
+//A header, the sprite clip of every tile type, then the tile records chunk by chunk, all little endian
+//Each chunk holds its cells row by row, chunks past the level edge are padded with empty tiles
+const char MAP_MAGIC[4] = {'L', 'V', 'L', 'M'};
+const Uint32 MAP_VERSION = 2;
+
+struct MapHeader {
+	char magic[4];
+	Uint32 version;
+
+	//Level dimensions in tiles
+	Uint32 columns;
+	Uint32 rows;
+
+	//Chunk side in tiles, the game only reads its own LEVEL_CHUNK_SIZE
+	Uint32 chunkSize;
+
+	//Byte offsets of the clip table and the tile records
+	Uint32 totalClips;
+	Uint32 clipOffset;
+	Uint32 tileOffset;
+};
+
+//Where a tile type sits in the sprite sheet
+struct MapClip {
+	Sint32 x, y, w, h;
+};
+
+//One cell, laid out like Tile so the records are used in place
+struct MapTile {
+	//Sprite clip index, also the tile type
+	Uint8 type;
+
+	//Collision flags
+	Uint8 flags;
+};
+#endif
@@ -1,9 +1,12 @@
 #include "npc.hpp"
+#include "character.hpp"
+#include "texturecache.hpp"
 #include <iostream>
 
-void Npc::render(SDL_Rect &camera, bool toggleParticles, SDL_Rect *clip, float scale) {
-	//Show the dot
-	if(checkCollision(camera, mBox)) {
+void Npc::render(SDL_Rect &camera, bool toggleParticles, float scale) {
+	//Show the frame the step picked
+	SDL_Rect *clip = gAnimations.getClip(animation);
+	if(npcTexture && clip != NULL && checkCollision(camera, mRenderBox)) {
 		/*
 		if(scale != 1.0) {
 			dstrect.w = (int) (clip->w * scale);
@@ -22,18 +25,18 @@ void Npc::render(SDL_Rect &camera, bool toggleParticles, SDL_Rect *clip, float s
 		dstrect.y = (int)(mPosY) - camera.y - dstrect.h + NPC_HEIGHT;
 		*/
 		// XXX FIXED.
-		dstrect.w = (int) (currentClip->w * scale);
-		dstrect.h = (int) (currentClip->h * scale);
-		if(flip == SDL_FLIP_HORIZONTAL) dstrect.x = (int)(mBox.x - camera.x - dstrect.w + NPC_WIDTH);
-		else dstrect.x = (int) (mBox.x - camera.x);
-		dstrect.y = (int) (mBox.y - camera.y);
+		dstrect.w = (int) (clip->w * scale);
+		dstrect.h = (int) (clip->h * scale);
+		if(flip == SDL_FLIP_HORIZONTAL) dstrect.x = (int)(mRenderBox.x - camera.x - dstrect.w + NPC_WIDTH);
+		else dstrect.x = (int) (mRenderBox.x - camera.x);
+		dstrect.y = (int) (mRenderBox.y - camera.y);
 
 		if(flip == SDL_FLIP_HORIZONTAL) {
 			// To adjust for clipping size.
-			npcTexture.render((int)(mPosX) - camera.x - clip->w + NPC_WIDTH, (int)(mPosY) - camera.y - clip->h + NPC_HEIGHT, clip, dstrect, 0, NULL, flip);
+			npcTexture->render((int)(mPosX) - camera.x - clip->w + NPC_WIDTH, (int)(mPosY) - camera.y - clip->h + NPC_HEIGHT, clip, dstrect, 0, NULL, flip);
 		}
 		else {
-			npcTexture.render((int)(mPosX) - camera.x, (int)(mPosY) - camera.y - clip->h + NPC_HEIGHT, clip, dstrect, 0, NULL, flip);
+			npcTexture->render((int)(mPosX) - camera.x, (int)(mPosY) - camera.y - clip->h + NPC_HEIGHT, clip, dstrect, 0, NULL, flip);
 		}
 	}
 
@@ -41,7 +44,7 @@ void Npc::render(SDL_Rect &camera, bool toggleParticles, SDL_Rect *clip, float s
 	//renderParticles(camera, toggleParticles);
 }
 
-Npc::Npc(int x, int y, int width, int height, int maxFrames, std::string filename) : NPC_WIDTH(width), NPC_HEIGHT(height), ANIMATION_FRAMES(maxFrames), SPRITESHEET_WIDTH(width * maxFrames) {
+Npc::Npc(int x, int y, int width, int height, std::string filename, Uint32 seed) : NPC_WIDTH(width), NPC_HEIGHT(height) {
 	//Initialize the collision box
 	mPosX = x;
 	mPosY = y;
@@ -50,33 +53,26 @@ Npc::Npc(int x, int y, int width, int height, int maxFrames, std::string filenam
 	mBox.y = 0;
 	mBox.w = NPC_WIDTH;
 	mBox.h = NPC_HEIGHT;
-	currentClip = &mBox;
+	mPrevPosX = mPosX;
+	mPrevPosY = mPosY;
+	mRenderBox = mBox;
+	mRenderBox.x = (int) mPosX;
+	mRenderBox.y = (int) mPosY;
 	isJumping = false;
 	isMoving = false;
 	wasStabbed = false;
 	wasJumped = false;
+	recoverySteps = 0;
 	flip = SDL_FLIP_NONE;
-	spriteClips.resize(maxFrames);
+	mRandom.setSeed(seed);
+	gAnimations.start(animation, gAnimations.findSet(filename));
 
-	//Load dot texture
-	if(!npcTexture.loadFromFile(filename)) {
-		printf("Failed to load dot texture!\n");
+	//Load dot texture, shared with every npc using the same sheet, not when headless
+	if(!gHeadless) {
+		npcTexture = gTextureCache.load(filename);
 	}
-	else {
-		int x = 0; 
-		int y = 0;
-		for(int i = 0; i < ANIMATION_FRAMES; ++i) {
-			spriteClips[i].x = x;
-			spriteClips[i].y = y;
-			spriteClips[i].w = 38;
-			spriteClips[i].h = 55;
-
-			x += 38 + 1;
-			if(x >= SPRITESHEET_WIDTH) {
-				x = 0;
-				y += TILE_HEIGHT;
-			}
-		}
+	if(!npcTexture && !gHeadless) {
+		printf("Failed to load dot texture!\n");
 	}
 
 	//Initialize the velocity
@@ -93,64 +89,94 @@ Npc::Npc(int x, int y, int width, int height, int maxFrames, std::string filenam
 
 Npc::~Npc() {
 	//std::cout << "hi mom" << std::endl;
-	npcTexture.free();
 }
 
-void Npc::move(Tile *tiles[], Character &character, float timeStep) {
+void Npc::applyHit(const NpcHit &hit) {
+	if(hit.jumped) {
+		wasJumped = true;
+	}
+	else {
+		wasStabbed = true;
+		setVelocityX(hit.velocityX);
+		startRecovery();
+	}
+}
+
+void Npc::animate(float timeStep) {
+	gAnimations.advance(animation, isMoving, (float) mVelY, timeStep);
+}
+
+void Npc::startRecovery() {
+	//Recovers on the first step more than NPC_RECOVERY_TIME after the stab
+	recoverySteps = (int) (NPC_RECOVERY_TIME * gSimulationRate) + 1;
+}
+
+void Npc::savePosition() {
+	mPrevPosX = mPosX;
+	mPrevPosY = mPosY;
+}
+
+void Npc::interpolate(float alpha) {
+	mRenderBox.x = (int) (mPrevPosX + (mPosX - mPrevPosX) * alpha);
+	mRenderBox.y = (int) (mPrevPosY + (mPosY - mPrevPosY) * alpha);
+}
+
+void Npc::move(TileMap &tiles, const CharacterState &character, float timeStep) {
 
 	int tileTouched;
+	SDL_Rect contact;
 
 	//Move the dot left or right
 	mPosX += mVelX * timeStep;
 
 	//If the dot went too far to the left or right or touched a wall
-	if((mPosX < 0) || (mPosX + NPC_WIDTH > LEVEL_WIDTH)) {
+	if((mPosX < 0) || (mPosX + NPC_WIDTH > tiles.getWidth())) {
 		//move back
 		if(mPosX < 0) {
 			mPosX = 0;
 		}
 		else {
-			mPosX = LEVEL_WIDTH - NPC_WIDTH;
+			mPosX = tiles.getWidth() - NPC_WIDTH;
 		}
 	}
-	mBox.x = mPosX;
-	tileTouched = touchesWall(mBox, tiles);
+	mBox.x = (int) mPosX;
+	tileTouched = touchesWall(mBox, tiles, contact);
 	if(tileTouched > -1 && mVelX > 0) {
-		if(tiles[tileTouched]->topHalf) mPosX = tiles[tileTouched]->getCollisionBox().x - NPC_WIDTH;
-		else if(tiles[tileTouched]->diagonalTile) {
+		if(tiles.isTopHalf(tileTouched)) mPosX = tiles.getCollisionBox(tileTouched).x - NPC_WIDTH;
+		else if(tiles.isDiagonal(tileTouched)) {
 			//std::cout << "hit!" << std::endl;
-			mPosY = tiles[tileTouched]->getPixelBox()[tiles[tileTouched]->pixelTouched].y - NPC_HEIGHT;
+			mPosY = contact.y - NPC_HEIGHT;
 		}
-		else mPosX = tiles[tileTouched]->getBox().x - NPC_WIDTH;
+		else mPosX = tiles.getBox(tileTouched).x - NPC_WIDTH;
 	}
 	if(tileTouched > -1 && mVelX < 0) {
-		if(tiles[tileTouched]->topHalf) mPosX = tiles[tileTouched]->getCollisionBox().x + TILE_WIDTH;
-		else mPosX = tiles[tileTouched]->getBox().x + TILE_WIDTH;
+		if(tiles.isTopHalf(tileTouched)) mPosX = tiles.getCollisionBox(tileTouched).x + TILE_WIDTH;
+		else mPosX = tiles.getBox(tileTouched).x + TILE_WIDTH;
 	}
-	if(checkCollision(mBox, character.getBoxPosition()) && mVelX > 0) {
-		mPosX = character.getPosX() - NPC_WIDTH;
+	if(checkCollision(mBox, character.box) && mVelX > 0) {
+		mPosX = character.posX - NPC_WIDTH;
 		if(character.isAttacking && character.flip == SDL_FLIP_HORIZONTAL) {
-			mPosX = character.getPosX() - NPC_WIDTH;
+			mPosX = character.posX - NPC_WIDTH;
 			wasStabbed = true;
 			mVelX = -15 * 60;
-			wasAttackedTimer.start();
+			startRecovery();
 		}
 	}
-	else if(checkCollision(mBox, character.getBoxPosition()) && mVelX < 0) {
-		mPosX = character.getPosX() + character.CHARACTER_WIDTH;
+	else if(checkCollision(mBox, character.box) && mVelX < 0) {
+		mPosX = character.posX + character.width;
 		if(character.isAttacking && character.flip == SDL_FLIP_NONE) {
-			mPosX = character.getPosX() + character.CHARACTER_WIDTH;
+			mPosX = character.posX + character.width;
 			wasStabbed = true;
 			mVelX = 15 * 60;
-			wasAttackedTimer.start();
+			startRecovery();
 		}
 	}
-	mBox.x = mPosX;
+	mBox.x = (int) mPosX;
 
 
 	// Gravity.
 	if(NPC_HEIGHT == (int) (105 * gScale)) {
-		switch(rand() % 3) {
+		switch(mRandom.range(3)) {
 			case 0:
 				mVelY += 3600 * timeStep;
 				break;
@@ -173,35 +199,35 @@ void Npc::move(Tile *tiles[], Character &character, float timeStep) {
 	mPosY += mVelY * timeStep;
 
 	//If the dot went too far up or down or touched a wall
-	if((mPosY < 0) || (mPosY + NPC_HEIGHT > LEVEL_HEIGHT)) {
+	if((mPosY < 0) || (mPosY + NPC_HEIGHT > tiles.getHeight())) {
 		if(mPosY < 0) mPosY = 0;
 		else {
-			mPosY = LEVEL_HEIGHT - NPC_HEIGHT;
+			mPosY = tiles.getHeight() - NPC_HEIGHT;
 			isJumping = false;
 		}
 	} 
-	mBox.y = mPosY;
-	tileTouched = touchesWall(mBox, tiles);
+	mBox.y = (int) mPosY;
+	tileTouched = touchesWall(mBox, tiles, contact);
 	if(tileTouched > -1 && mVelY > 0) {
-		if(tiles[tileTouched]->topHalf) mPosY = tiles[tileTouched]->getCollisionBox().y - NPC_HEIGHT;
-		else if(tiles[tileTouched]->diagonalTile) {
+		if(tiles.isTopHalf(tileTouched)) mPosY = tiles.getCollisionBox(tileTouched).y - NPC_HEIGHT;
+		else if(tiles.isDiagonal(tileTouched)) {
 			//std::cout << "hit!" << std::endl;
-			mPosY = tiles[tileTouched]->getPixelBox()[tiles[tileTouched]->pixelTouched].y - NPC_HEIGHT;
+			mPosY = contact.y - NPC_HEIGHT;
 		}
-		else mPosY = tiles[tileTouched]->getBox().y - NPC_HEIGHT;
+		else mPosY = tiles.getBox(tileTouched).y - NPC_HEIGHT;
 		isJumping = false;
 	}
 	if(tileTouched > -1 && mVelY < 0) {
-		if(tiles[tileTouched]->topHalf) mPosY = tiles[tileTouched]->getCollisionBox().y + tiles[tileTouched]->getCollisionBox().h;
-		else mPosY = tiles[tileTouched]->getBox().y + TILE_HEIGHT;
+		if(tiles.isTopHalf(tileTouched)) mPosY = tiles.getCollisionBox(tileTouched).y + tiles.getCollisionBox(tileTouched).h;
+		else mPosY = tiles.getBox(tileTouched).y + TILE_HEIGHT;
 	}
-	if(checkCollision(mBox, character.getBoxPosition()) && mVelY > 0) {
-		mPosY = character.getPosY() - NPC_HEIGHT;
+	if(checkCollision(mBox, character.box) && mVelY > 0) {
+		mPosY = character.posY - NPC_HEIGHT;
 	}
-	if(checkCollision(mBox, character.getBoxPosition()) && mVelY < 0) {
-		if(!character.isAttacking) mPosY = character.getPosY() + character.CHARACTER_HEIGHT;
+	if(checkCollision(mBox, character.box) && mVelY < 0) {
+		if(!character.isAttacking) mPosY = character.posY + character.height;
 	}
-	mBox.y = mPosY;
+	mBox.y = (int) mPosY;
 }
 
 /*
@@ -1,16 +1,37 @@
 #ifndef NPC_HPP
 	#define NPC_HPP
 #include <SDL.h>
-#include "tiles.hpp"
+#include "tilemap.hpp"
 #include "globals.hpp"
+#include "fixed.hpp"
+#include "random.hpp"
+#include <memory>
 #include "texture.hpp"
-#include "character.hpp"
-#include "timer.hpp"
+#include "animation.hpp"
 
-extern int touchesWall(SDL_Rect box, Tile *tiles[]);
-extern bool touchesTap(SDL_Rect box, Tile *tiles[]);
+extern int touchesWall(SDL_Rect box, TileMap &tiles, SDL_Rect &contact);
+extern bool touchesTap(SDL_Rect box, TileMap &tiles);
 
 class Character;
+struct CharacterState;
+
+//Something the character did to an npc, applied between the character and npc updates
+struct NpcHit {
+	int npc;
+	bool jumped;
+
+	//Pushback from a stab
+	Real velocityX;
+};
+
+//Where an npc enters the level and its sheet, kept to spawn it again on a restart
+struct NpcSpawn {
+	int x, y;
+	std::string sheet;
+
+	//Of its random sequence
+	Uint32 seed;
+};
 
 class Npc {
 	public:
@@ -22,21 +43,22 @@ class Npc {
 		//The dimensions of the dot
 		const int NPC_WIDTH;
 		const int NPC_HEIGHT;
-		const int ANIMATION_FRAMES;
-		const int SPRITESHEET_WIDTH;
 
-		//Initializes the variables, allocates particles.
-		Npc(int x, int y, int width, int height, int maxFrames, std::string filename);
+		//Initializes the variables, the sheet picks the animations, seed starts its own random sequence
+		Npc(int x, int y, int width, int height, std::string filename, Uint32 seed);
 
 		bool wasStabbed;
 		bool wasJumped;
-		LTimer wasAttackedTimer;
+
+		//Steps left until a stab wears off, counted in steps so replays recover on the same one
+		int recoverySteps;
 		SDL_Rect dstrect = { 0, 0, NPC_WIDTH, NPC_HEIGHT };
 
 		// Texture.
-		LTexture npcTexture;
-		std::vector<SDL_Rect> spriteClips;
-		SDL_Rect *currentClip;
+		std::shared_ptr<LTexture> npcTexture;
+
+		// Animation, moved on with the dot.
+		AnimationState animation;
 
 		// Deallocates particles.
 		~Npc();
@@ -44,14 +66,26 @@ class Npc {
 		//Takes key presses and adjusts the dot's velocity
 		void handleEvent(SDL_Event &e);
 
-		//Moves the dot and check collision against tiles
-		void move(Tile *tiles[], Character &character, float timeStep);
+		//Moves the dot and check collision against tiles, writes nothing but the dot
+		void move(TileMap &tiles, const CharacterState &character, float timeStep);
+
+		//Moves the animation on by a step, after the move
+		void animate(float timeStep);
+
+		//Applies what the character did to the dot
+		void applyHit(const NpcHit &hit);
+
+		//Remembers where the step started, for render interpolation
+		void savePosition();
+
+		//Places the render box between the last two steps
+		void interpolate(float alpha);
 
 		//Centers the camera over the dot
 		//void setCamera(SDL_Rect &camera);
 
 		//Shows the dot on the screen
-		void render(SDL_Rect &camera, bool toggleParticles = false, SDL_Rect *clip = NULL, float scale = 1);
+		void render(SDL_Rect &camera, bool toggleParticles = false, float scale = 1);
 
 		bool isJumping;
 		bool isMoving;
@@ -62,27 +96,27 @@ class Npc {
 			return mBox;
 		}
 
-		inline float getPosX() {
+		inline Real getPosX() {
 			return mPosX;
 		}
 
-		inline float getPosY() {
+		inline Real getPosY() {
 			return mPosY;
 		}
 
-		inline float getVelocityX() {
+		inline Real getVelocityX() {
 			return mVelX;
 		}
 
-		inline float getVelocityY() {
+		inline Real getVelocityY() {
 			return mVelY;
 		}
 
-		inline void setVelocityX(float velocity) {
+		inline void setVelocityX(Real velocity) {
 			mVelX = velocity;
 		}
 
-		inline void setVelocityY(float velocity) {
+		inline void setVelocityY(Real velocity) {
 			mVelY = velocity;
 		}
 
@@ -97,9 +131,19 @@ class Npc {
 
 		//Collision box of the dot
 		SDL_Rect mBox;
-		float mPosX, mPosY;
+
+		//Where the dot is drawn
+		SDL_Rect mRenderBox;
+		Real mPrevPosX, mPrevPosY;
+		Real mPosX, mPosY;
 
 		//The velocity of the dot
-		float mVelX, mVelY;
+		Real mVelX, mVelY;
+
+		//Starts counting down the recovery from a stab
+		void startRecovery();
+
+		//Own random sequence, so dots can move on any thread
+		Random mRandom;
 };
 #endif
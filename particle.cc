@@ -1,37 +1,112 @@
 #include "particle.hpp"
 
-Particle::Particle(int x, int y, SDL_Rect mBox) {
+// Types of particle.
+enum ParticleColor {PARTICLE_RED, PARTICLE_GREEN, PARTICLE_BLUE, TOTAL_PARTICLE_COLORS};
+
+ParticlePool::ParticlePool(int capacity) {
+	mCapacity = capacity;
+	mPosX.resize(mCapacity);
+	mPosY.resize(mCapacity);
+	mFrame.resize(mCapacity);
+	mColor.resize(mCapacity);
+	mSize = 0;
+	mEnabled = true;
+}
+
+void ParticlePool::setSeed(Uint32 seed) {
+	mRandom.setSeed(seed);
+}
+
+void ParticlePool::spawn(SDL_Rect &box) {
+	if(mSize == mCapacity) {
+		return;
+	}
+
 	// Set offsets.
-	mPosX = x - 5 + (rand() % (mBox.w + 5));
-	mPosY = y - 5 + (rand() % (mBox.h + 5));
+	mPosX[mSize] = box.x - 5 + mRandom.range(box.w + 5);
+	mPosY[mSize] = box.y - 5 + mRandom.range(box.h + 5);
 
 	// Initialize the animation.
-	mFrame = rand() % 5;
+	mFrame[mSize] = mRandom.range(5);
 
 	// Set type.
-	switch(rand() % 3) {
-		case 0: mTexture = &gRedTexture; break;
-		case 1: mTexture = &gGreenTexture; break;
-		case 2: mTexture = &gBlueTexture; break;
+	mColor[mSize] = mRandom.range(TOTAL_PARTICLE_COLORS);
+	++mSize;
+}
+
+void ParticlePool::emit(ParticleEmitter &emitter, SDL_Rect box, float timeStep) {
+	if(!mEnabled) {
+		return;
+	}
+	emitter.pending += emitter.rate * timeStep;
+	while(emitter.pending >= 1) {
+		spawn(box);
+		emitter.pending -= 1;
 	}
 }
 
-void Particle::render() {
-	// Show image.
-	mTexture->render(mPosX, mPosY);
+void ParticlePool::burst(SDL_Rect box, int count) {
+	if(!mEnabled) {
+		return;
+	}
+	for(int i = 0; i < count; ++i) {
+		spawn(box);
+	}
+}
+
+void ParticlePool::update() {
+	// Animate, moving the last particle into each dead slot.
+	int i = 0;
+	while(i < mSize) {
+		if(++mFrame[i] > PARTICLE_FRAMES) {
+			--mSize;
+			mPosX[i] = mPosX[mSize];
+			mPosY[i] = mPosY[mSize];
+			mFrame[i] = mFrame[mSize];
+			mColor[i] = mColor[mSize];
+		}
+		else {
+			++i;
+		}
+	}
+}
+
+void ParticlePool::render(SDL_Rect &camera) {
+	if(!mEnabled) {
+		return;
+	}
 
-	// show shimmer.
-	if(mFrame % 2 == 0) {
-		gShimmerTexture.render(mPosX, mPosY);
+	// One pass per texture so the renderer can batch the copies.
+	LTexture *textures[TOTAL_PARTICLE_COLORS] = {&gRedTexture, &gGreenTexture, &gBlueTexture};
+	int width = gShimmerTexture.getWidth();
+	int height = gShimmerTexture.getHeight();
+	int left = camera.x - width;
+	int top = camera.y - height;
+	int right = camera.x + camera.w;
+	int bottom = camera.y + camera.h;
+	for(int color = 0; color < TOTAL_PARTICLE_COLORS; ++color) {
+		for(int i = 0; i < mSize; ++i) {
+			if(mColor[i] == color && mPosX[i] > left && mPosX[i] < right && mPosY[i] > top && mPosY[i] < bottom) {
+				textures[color]->render(mPosX[i] - camera.x, mPosY[i] - camera.y);
+			}
+		}
 	}
 
-	// animate.
-	mFrame++;
+	// Show shimmer on every other frame.
+	for(int i = 0; i < mSize; ++i) {
+		if(mFrame[i] % 2 == 0 && mPosX[i] > left && mPosX[i] < right && mPosY[i] > top && mPosY[i] < bottom) {
+			gShimmerTexture.render(mPosX[i] - camera.x, mPosY[i] - camera.y);
+		}
+	}
 }
 
-bool Particle::isDead() {
-	return mFrame > frameCap;
+void ParticlePool::clear() {
+	mSize = 0;
 }
 
-Particle::~Particle() {
+void ParticlePool::setEnabled(bool enabled) {
+	mEnabled = enabled;
+	if(!mEnabled) {
+		clear();
+	}
 }
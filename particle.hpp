@@ -1,33 +1,68 @@
 #ifndef PARTICLE_HPP
 	#define PARTICLE_HPP
-
+#include <vector>
 #include "globals.hpp"
-class Particle {
+#include "random.hpp"
+
+// Spawns particles over a box at a steady rate.
+struct ParticleEmitter {
+	// Particles per second.
+	float rate;
+
+	// Fraction of a particle carried to the next step.
+	float pending;
+};
+
+// Fixed pool of particles kept as parallel arrays, updated in the simulation and drawn separately.
+class ParticlePool {
 	public:
-		// Initialize position and animation.
-		Particle(int x, int y, SDL_Rect mBox);
+		// Allocates room for every particle up front.
+		ParticlePool(int capacity = MAX_PARTICLES);
+
+		// Spawns the particles an emitter owes for a step, spread over box.
+		void emit(ParticleEmitter &emitter, SDL_Rect box, float timeStep);
 
-		~Particle();
+		// Spawns count particles at once, spread over box.
+		void burst(SDL_Rect box, int count);
 
-		// Shows the particle.
-		void render();
+		// Animates the particles and drops the dead ones.
+		void update();
 
-		int frameCap = 10;
+		// Shows the particles under the camera, grouped by texture.
+		void render(SDL_Rect &camera);
 
-		// Checks if particle is dead.
-		bool isDead();
+		// Kills every particle.
+		void clear();
 
-		inline void setFrame(int value) {
-			frameCap = value;
+		// Restarts the random sequence spawning uses.
+		void setSeed(Uint32 seed);
+
+		// Stops emitting and clears when disabled.
+		void setEnabled(bool enabled);
+
+		inline int getSize() {
+			return mSize;
 		}
 
 	private:
-		// Offsets
-		int mPosX, mPosY;
+		// Spawns one particle, dropped when the pool is full.
+		void spawn(SDL_Rect &box);
+
+		// Positions.
+		std::vector<int> mPosX;
+		std::vector<int> mPosY;
+
 		// Current frame of animation.
-		int mFrame;
+		std::vector<Uint8> mFrame;
 
 		// Type of particle.
-		LTexture *mTexture;
+		std::vector<Uint8> mColor;
+
+		int mSize;
+		int mCapacity;
+		bool mEnabled;
+
+		// Its own sequence, so drawing particles or not never changes the rest of the world.
+		Random mRandom;
 };
 #endif
@@ -0,0 +1,183 @@
+#include "profiler.hpp"
+#include "logger.hpp"
+#include "globals.hpp"
+#include <stdio.h>
+#include <string.h>
+
+//Buffer of the calling thread, and the profiler it belongs to
+static thread_local Profiler *tOwner = NULL;
+static thread_local void *tBuffer = NULL;
+
+Profiler::Profiler() {
+	mEnabled.store(false);
+	mFrameStart = 0;
+	mFrames = 0;
+	mTraceFrames = 0;
+}
+
+Profiler::~Profiler() {
+	for(unsigned int i = 0; i < mBuffers.size(); ++i) {
+		delete mBuffers[i];
+	}
+}
+
+void Profiler::setEnabled(bool enabled) {
+	mEnabled.store(enabled, std::memory_order_relaxed);
+	mFrameStart = SDL_GetPerformanceCounter();
+}
+
+void Profiler::record(const char *name, Uint64 start, Uint64 end) {
+	ThreadBuffer *buffer = getBuffer();
+	ProfileEvent event = {name, start, end};
+	std::lock_guard<std::mutex> guard(buffer->lock);
+	buffer->events.push_back(event);
+}
+
+Profiler::ThreadBuffer *Profiler::getBuffer() {
+	if(tOwner != this) {
+		ThreadBuffer *buffer = new ThreadBuffer();
+		std::lock_guard<std::mutex> guard(mBuffersLock);
+		buffer->thread = (int) mBuffers.size();
+		mBuffers.push_back(buffer);
+		tOwner = this;
+		tBuffer = buffer;
+	}
+	return (ThreadBuffer *) tBuffer;
+}
+
+void Profiler::endFrame() {
+	if(!isEnabled()) {
+		return;
+	}
+	Uint64 frameEnd = SDL_GetPerformanceCounter();
+
+	for(unsigned int i = 0; i < mStats.size(); ++i) {
+		mStats[i].frameMs = 0;
+	}
+
+	//The frame itself goes in like a zone of the main thread
+	ProfileEvent frame = {"frame", mFrameStart, frameEnd};
+	addToStats(frame);
+	if(mTraceFrames > 0) {
+		TraceEvent traced = {frame, getBuffer()->thread};
+		mTrace.push_back(traced);
+	}
+
+	//Threads that start later get buffers while we look
+	std::vector<ThreadBuffer *> buffers;
+	{
+		std::lock_guard<std::mutex> guard(mBuffersLock);
+		buffers = mBuffers;
+	}
+	for(unsigned int i = 0; i < buffers.size(); ++i) {
+		{
+			std::lock_guard<std::mutex> guard(buffers[i]->lock);
+			mTaken.swap(buffers[i]->events);
+		}
+		for(unsigned int j = 0; j < mTaken.size(); ++j) {
+			addToStats(mTaken[j]);
+			if(mTraceFrames > 0) {
+				TraceEvent traced = {mTaken[j], buffers[i]->thread};
+				mTrace.push_back(traced);
+			}
+		}
+		mTaken.clear();
+	}
+
+	//Zones that did not run this frame count as zero
+	for(unsigned int i = 0; i < mStats.size(); ++i) {
+		ZoneStats &stats = mStats[i];
+		stats.averageMs += (stats.frameMs - stats.averageMs) / PROFILE_AVERAGE_FRAMES;
+		if(stats.frameMs > stats.worstMs) {
+			stats.worstMs = stats.frameMs;
+		}
+	}
+	if(++mFrames == PROFILE_AVERAGE_FRAMES) {
+		for(unsigned int i = 0; i < mStats.size(); ++i) {
+			mStats[i].shownWorstMs = mStats[i].worstMs;
+			mStats[i].worstMs = 0;
+		}
+		mFrames = 0;
+	}
+
+	if(mTraceFrames > 0 && --mTraceFrames == 0) {
+		writeTrace();
+	}
+	mFrameStart = frameEnd;
+}
+
+void Profiler::addToStats(const ProfileEvent &event) {
+	double ms = (event.end - event.start) * 1000.0 / SDL_GetPerformanceFrequency();
+
+	//Few zones, a search is fine, names from different files can differ in address
+	for(unsigned int i = 0; i < mStats.size(); ++i) {
+		if(mStats[i].name == event.name || strcmp(mStats[i].name, event.name) == 0) {
+			mStats[i].frameMs += ms;
+			return;
+		}
+	}
+	ZoneStats stats = {event.name, ms, ms, ms, ms};
+	mStats.push_back(stats);
+}
+
+void Profiler::captureTrace(std::string path, int frames) {
+	mTrace.clear();
+	mTracePath = path;
+	mTraceFrames = frames;
+}
+
+bool Profiler::isCapturing() {
+	return mTraceFrames > 0;
+}
+
+bool Profiler::writeTrace() {
+	mTraceFrames = 0;
+	FILE *file = fopen(mTracePath.c_str(), "w");
+	if(file == NULL) {
+		printf("Unable to create trace %s!\n", mTracePath.c_str());
+		mTrace.clear();
+		return false;
+	}
+
+	//Complete events in microseconds from the first one
+	Uint64 first = mTrace.empty() ? 0 : mTrace[0].event.start;
+	for(unsigned int i = 0; i < mTrace.size(); ++i) {
+		if(mTrace[i].event.start < first) {
+			first = mTrace[i].event.start;
+		}
+	}
+	double frequency = SDL_GetPerformanceFrequency() / 1000000.0;
+	fprintf(file, "{\"traceEvents\": [\n");
+	for(unsigned int i = 0; i < mTrace.size(); ++i) {
+		const ProfileEvent &event = mTrace[i].event;
+		fprintf(file, "{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f},\n", event.name, mTrace[i].thread, (event.start - first) / frequency, (event.end - event.start) / frequency);
+	}
+
+	//Thread names, the one that ends frames is the main thread
+	{
+		std::lock_guard<std::mutex> guard(mBuffersLock);
+		for(unsigned int i = 0; i < mBuffers.size(); ++i) {
+			fprintf(file, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"%s %d\"}}%s\n", i, mBuffers[i] == tBuffer ? "main" : "worker", i, i + 1 < mBuffers.size() ? "," : "");
+		}
+	}
+	fprintf(file, "]}\n");
+
+	bool written = fclose(file) == 0;
+	if(!written) {
+		printf("Unable to write trace %s!\n", mTracePath.c_str());
+	}
+	else {
+		LOG_INFO("wrote trace " + mTracePath);
+	}
+	mTrace.clear();
+	return written;
+}
+
+void Profiler::render(GlyphAtlas &text, int x, int y, SDL_Color color) {
+	char line[96];
+	for(unsigned int i = 0; i < mStats.size(); ++i) {
+		snprintf(line, sizeof(line), "%s %.2f ms, worst %.2f", mStats[i].name, mStats[i].averageMs, mStats[i].shownWorstMs);
+		text.render(x, y, line, color);
+		y += text.getHeight();
+	}
+}
@@ -0,0 +1,128 @@
+#ifndef PROFILER_HPP
+	#define PROFILER_HPP
+#include <SDL.h>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include "glyphatlas.hpp"
+
+//A stretch of time one thread spent in a zone, in performance counter ticks
+struct ProfileEvent {
+	const char *name;
+	Uint64 start;
+	Uint64 end;
+};
+
+//Times named zones of each frame on any thread, for an overlay and Chrome trace files
+//Each thread keeps its own buffer, the main thread collects them once a frame
+class Profiler {
+	public:
+		//Starts disabled
+		Profiler();
+
+		//Deallocates the thread buffers
+		~Profiler();
+
+		//Zones only cost a check while disabled
+		void setEnabled(bool enabled);
+
+		inline bool isEnabled() {
+			return mEnabled.load(std::memory_order_relaxed);
+		}
+
+		//Adds a zone to the buffer of the calling thread
+		void record(const char *name, Uint64 start, Uint64 end);
+
+		//Collects the zones of every thread into the averages, and into the trace while one is captured
+		//Call once a frame from the main thread
+		void endFrame();
+
+		//Captures the zones of the next frames, then writes them to a file as Chrome trace JSON
+		void captureTrace(std::string path, int frames);
+
+		bool isCapturing();
+
+		//Draws the average and worst time of each zone over the last frames
+		void render(GlyphAtlas &text, int x, int y, SDL_Color color);
+
+	private:
+		struct ThreadBuffer {
+			//Only contended while endFrame() takes the events
+			std::mutex lock;
+			std::vector<ProfileEvent> events;
+
+			//Order the thread first recorded in, its id in the trace
+			int thread;
+		};
+
+		//Times of a zone name, in milliseconds
+		struct ZoneStats {
+			const char *name;
+			double frameMs;
+			double averageMs;
+			double worstMs;
+			double shownWorstMs;
+		};
+
+		//A captured event and the thread it ran on
+		struct TraceEvent {
+			ProfileEvent event;
+			int thread;
+		};
+
+		//Gets the buffer of the calling thread, making it on its first zone
+		ThreadBuffer *getBuffer();
+
+		//Adds an event to the frame times of its zone
+		void addToStats(const ProfileEvent &event);
+
+		//Writes the captured trace and stops capturing
+		bool writeTrace();
+
+		std::atomic<bool> mEnabled;
+
+		std::mutex mBuffersLock;
+		std::vector<ThreadBuffer *> mBuffers;
+
+		//Events taken from a thread buffer, swapped with it to keep both allocations
+		std::vector<ProfileEvent> mTaken;
+
+		std::vector<ZoneStats> mStats;
+
+		//When the frame started, and frames counted toward the worst times
+		Uint64 mFrameStart;
+		int mFrames;
+
+		//Trace being captured, its file and the frames left
+		std::vector<TraceEvent> mTrace;
+		std::string mTracePath;
+		int mTraceFrames;
+};
+
+extern Profiler gProfiler;
+
+//Times the rest of the scope as a zone, name has to be a string literal
+#define PROFILE_CONCAT(a, b) a##b
+#define PROFILE_NAME(line) PROFILE_CONCAT(profileZone, line)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_NAME(__LINE__)(name)
+
+//Records a zone from its construction to the end of its scope
+class ProfileZone {
+	public:
+		inline ProfileZone(const char *name) {
+			mName = name;
+			mStart = gProfiler.isEnabled() ? SDL_GetPerformanceCounter() : 0;
+		}
+
+		inline ~ProfileZone() {
+			if(mStart != 0) {
+				gProfiler.record(mName, mStart, SDL_GetPerformanceCounter());
+			}
+		}
+
+	private:
+		const char *mName;
+		Uint64 mStart;
+};
+#endif
@@ -10,82 +10,72 @@
 #include <vector>
 #include "npc.hpp"
 #include "texture.hpp"
+#include "texturecache.hpp"
+#include "assetloader.hpp"
+#include "glyphatlas.hpp"
+#include "logger.hpp"
 #include "tiles.hpp"
+#include "tilemap.hpp"
+#include "spatialhash.hpp"
+#include "jobs.hpp"
 #include "particle.hpp"
+#include "random.hpp"
+#include "inputlog.hpp"
+#include "profiler.hpp"
 #include "timer.hpp"
+#include "gameclock.hpp"
+#include "framepacer.hpp"
+#include "animation.hpp"
 #include "button.hpp"
 #include "character.hpp"
+#include "world.hpp"
 #include "globals.hpp"
 
-//The window we'll be rendering to
-SDL_Window *gWindow;
+// Font.
+GlyphAtlas gHudText;
 
-//The window renderer
-SDL_Renderer *gRenderer; 
-
-// Globally used font.
-TTF_Font *gFont = NULL;
-LTexture gTextCoordinates;
-LTexture gFpsTextTexture;
-LTexture gTextVelocity;
-LTexture gMouseCoordinates;
-
-float gScale;
 float gCharacterWidthScale;
 float gCharacterHeightScale;
 int gCharacterFrameRate;
 
-LTexture gButtonSpriteSheetTexture;
-LButton gButtons[TOTAL_BUTTONS];
-SDL_Rect gSpriteClips[BUTTON_SPRITE_TOTAL];
-
-//Scene textures
-LTexture gTileTexture;
-SDL_Rect gTileClips[TOTAL_TILE_SPRITES];
-
 LTexture gBGTexture;
 
-LTexture gRedTexture;
-LTexture gGreenTexture;
-LTexture gBlueTexture;
-LTexture gShimmerTexture;
-
-Mix_Music *gMusic[4];
-
-std::ofstream logger;
-
 //int counter = 0;
 
-void log(std::string message) {
-	// Write message to file.
-	logger << message << " " << std::endl;
-
-	// Flush the buffer.
-	logger.flush();
-}
-
 //The character that will move around on the screen
 //Starts up SDL and creates window
 bool init();
 
-//Loads media
-bool loadMedia(Tile *tiles[]);
+//Reads config.txt
+bool loadConfig();
+
+//Loads media, decoding on worker threads behind a loading screen
+bool loadMedia(TileMap &tiles);
+void renderLoadingScreen(float progress);
 
 //Frees media and shuts down SDL
-void close(Tile *tiles[]);
+void close(TileMap &tiles);
+
+//Options from the command line, map, npcs and ticks only apply to runs without a window
+struct GameOptions {
+	std::string map;
+	int npcs;
+	int ticks;
+	unsigned int seed;
 
-//Sets tiles from tile map
-bool setTiles(Tile *tiles[], std::string mapName);
+	//Simulation threads, -1 for one per core
+	int threads;
 
-//Box collision detector
-bool checkCollision(SDL_Rect a, SDL_Rect b);
-int checkDiagonalCollision(SDL_Rect a, std::vector<SDL_Rect> &b);
+	//Input files to write, or to play back instead of the keyboard and mouse, only with a window
+	std::string record;
+	std::string replay;
 
-//Checks collision box against set of tiles
-int touchesWall(SDL_Rect box, Tile *tiles[]);
-bool touchesTap(SDL_Rect box, Tile *tiles[]);
+	//Frame rate over the one in config.txt, a number, uncapped or display
+	std::string fps;
+};
 
-int touchesNpc(SDL_Rect box, std::vector<Npc *> &npcVector);
+//Runs the simulation alone and reports how fast it went, returns the exit code
+int runHeadless(GameOptions &options, JobSystem &jobs);
 
 bool init() {
 	//Initialization flag
@@ -109,8 +99,12 @@ bool init() {
 			success = false;
 		}
 		else {
-			//Create renderer for window
-			gRenderer = SDL_CreateRenderer(gWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+			//Create renderer for window, synced to the display only when that is the frame rate
+			Uint32 rendererFlags = SDL_RENDERER_ACCELERATED;
+			if(gFrameRate == FRAME_RATE_DISPLAY) {
+				rendererFlags |= SDL_RENDERER_PRESENTVSYNC;
+			}
+			gRenderer = SDL_CreateRenderer(gWindow, -1, rendererFlags);
 			if(gRenderer == NULL) {
 				printf("Renderer could not be created! SDL Error: %s\n", SDL_GetError());
 				success = false;
@@ -141,9 +135,15 @@ bool init() {
 		}
 	}
 
+	return success;
+}
+
+bool loadConfig() {
+	bool success = true;
+
 	// load configuration file.
 	std::ifstream config("config.txt");
-	if(config == NULL) {
+	if(!config) {
 		printf("unable to load config file.");
 		success = false;
 	}
@@ -157,43 +157,110 @@ bool init() {
 		config >> gCharacterWidthScale;
 		config >> tmp;
 		config >> gCharacterHeightScale;
+
+		// Optional, older config files end before it.
+		int simulationRate;
+		if(config >> tmp >> simulationRate && simulationRate > 0) {
+			gSimulationRate = simulationRate;
+		}
+
+		// Optional too, frames per second, 0 for uncapped or -1 for the display rate.
+		int frameRate;
+		if(config >> tmp >> frameRate && frameRate >= FRAME_RATE_DISPLAY) {
+			gFrameRate = frameRate;
+		}
 		config.close();
 	}
 
 	return success;
 }
 
-bool loadMedia(Tile *tiles[]) {
+// Draws a progress bar while the loader works.
+void renderLoadingScreen(float progress) {
+	SDL_SetRenderDrawColor(gRenderer, 0xFF, 0xFF, 0xFF, 0xFF);
+	SDL_RenderClear(gRenderer);
+
+	SDL_Rect bar = {SCREEN_WIDTH / 4, SCREEN_HEIGHT / 2 - 10, SCREEN_WIDTH / 2, 20};
+	SDL_SetRenderDrawColor(gRenderer, 0x00, 0x00, 0x00, 0xFF);
+	SDL_RenderDrawRect(gRenderer, &bar);
+	bar.w = (int) (bar.w * progress);
+	SDL_RenderFillRect(gRenderer, &bar);
+
+	SDL_RenderPresent(gRenderer);
+}
+
+bool loadMedia(TileMap &tiles) {
 	//Loading success flag
 	bool success = true;
 
-	// Load red texture.
-	if(!gRedTexture.loadFromFile("red.bmp")) {
-		printf("failed to load red texture\n");
-		success = false;
-	}
+	// Decode the files on worker threads, the textures are uploaded here as they come in.
+	AssetLoader loader;
+	loader.addImage("red.bmp", &gRedTexture);
+	loader.addImage("green.bmp", &gGreenTexture);
+	loader.addImage("blue.bmp", &gBlueTexture);
+	loader.addImage("shimmer.bmp", &gShimmerTexture);
+	loader.addImage("gamebackground.png", &gBGTexture);
+	loader.addImage("tiles.png", &gTileTexture);
+	loader.addImage("button.png", &gButtonSpriteSheetTexture);
+
+	// Sheets the character and npcs take from the texture cache.
+	loader.addImage("zerowalk.png");
+	loader.addImage("character1.png");
+	loader.addImage("character2.png");
+	loader.addImage("character3.png");
+	loader.addImage("character4.png");
+
+	// Opening the font, the glyph atlas needs the renderer.
+	loader.add([] {
+		gFont = TTF_OpenFont("lazy.ttf", 28);
+		if(gFont == NULL) {
+			printf("failed to load font, error: %s\n", TTF_GetError());
+			return false;
+		}
+		return true;
+	}, [] {
+		if(!gHudText.loadFromFont(gFont)) {
+			printf("failed to build the glyph atlas!\n");
+			return false;
+		}
+		return true;
+	});
+
+	// Load music, one song after the other.
+	loader.add([] {
+		bool loaded = true;
+		const char *songs[2] = {"tokage.mid", "wild.mid"};
+		for(int i = 0; i < 2; ++i) {
+			gMusic[i] = Mix_LoadMUS(songs[i]);
+			if(gMusic[i] == NULL) {
+				printf("failed to load music, error: %s\n", Mix_GetError());
+				loaded = false;
+			}
+		}
+		return loaded;
+	});
 
-	// Load green texture.
-	if(!gGreenTexture.loadFromFile("green.bmp")) {
-		printf("failed to load green texture\n");
+	//Load tile map while the workers decode
+	if(!setTiles(tiles, "lazy.map")) {
+		printf("Failed to load tile set!\n");
 		success = false;
 	}
 
-	// Load blue texture.
-	if(!gBlueTexture.loadFromFile("blue.bmp")) {
-		printf("failed to load blue texture\n");
+	// Animations of the character and npcs, the walk follows the character frame rate in config.txt.
+	if(!gAnimations.load("animations.txt")) {
+		printf("Failed to load animations!\n");
 		success = false;
 	}
+	gAnimations.setFrameTime(gAnimations.findSet("zerowalk.png"), gCharacterFrameRate);
 
-	// Load shimmer texture.
-	if(!gShimmerTexture.loadFromFile("shimmer.bmp")) {
-		printf("failed to load shimmer texture\n");
-		success = false;
+	// Keep drawing until every file is in.
+	while(!loader.isDone()) {
+		SDL_PumpEvents();
+		loader.upload(LOADING_UPLOAD_TIME);
+		renderLoadingScreen(loader.getProgress());
 	}
-
-	// Load background texture.
-	if(!gBGTexture.loadFromFile("gamebackground.png")) {
-		printf( "Failed to load background texture!\n" );
+	if(loader.hasFailed()) {
+		printf("failed to load media files!\n");
 		success = false;
 	}
 
@@ -203,86 +270,46 @@ bool loadMedia(Tile *tiles[]) {
 	gBlueTexture.setAlpha(172);
 	gShimmerTexture.setAlpha(172);
 
-	//Load tile texture
-	if(!gTileTexture.loadFromFile("tiles.png")) {
-		printf("Failed to load tile set texture!\n");
-		success = false;
+	//Set sprites
+	for( int i = 0; i < BUTTON_SPRITE_TOTAL; ++i )
+	{
+		gSpriteClips[i].x = 0;
+		gSpriteClips[i].y = i * 200;
+		gSpriteClips[i].w = BUTTON_WIDTH;
+		gSpriteClips[i].h = BUTTON_HEIGHT;
 	}
 
-	//Load tile map
-	if(!setTiles(tiles, "lazy.map")) {
-		printf("Failed to load tile set!\n");
-		success = false;
-	}
-
-	// Opening the font.
-	gFont = TTF_OpenFont("lazy.ttf", 28); 
-	if(gFont == NULL) {
-		printf("failed to load font, error: %s\n", TTF_GetError());
-		success = false;
-	}
-	//Load sprites
-	if(!gButtonSpriteSheetTexture.loadFromFile("button.png")) {
-		printf( "Failed to load button sprite texture!\n" );
-		success = false;
-	}
-	else {
-		//Set sprites
-		for( int i = 0; i < BUTTON_SPRITE_TOTAL; ++i )
-		{
-			gSpriteClips[i].x = 0;
-			gSpriteClips[i].y = i * 200;
-			gSpriteClips[i].w = BUTTON_WIDTH;
-			gSpriteClips[i].h = BUTTON_HEIGHT;
-		}
-
-		//Set buttons in corners
-		gButtons[0].setPosition(gButtons[0].dstrect.x, gButtons[0].dstrect.y);
-	}
-
-	// Load music.
-	gMusic[0] = Mix_LoadMUS("tokage.mid");
-	if(gMusic[0] == NULL) {
-		printf("failed to load music, error: %s\n", Mix_GetError());
-		success = false;
-	}
-	gMusic[1] = Mix_LoadMUS("wild.mid");
-	if(gMusic[1] == NULL) {
-		printf("failed to load music, error: %s\n", Mix_GetError());
-		success = false;
-	}
+	//Set buttons in corners
+	gButtons[0].setPosition(gButtons[0].dstrect.x, gButtons[0].dstrect.y);
 
 	return success;
 }
 
-void close(Tile *tiles[]) {
+void close(TileMap &tiles) {
 	//Deallocate tiles
-	for(int i = 0; i < TOTAL_TILES; ++i) {
-		if(tiles[i] == NULL) {
-			delete tiles[i];
-			tiles[i] = NULL;
-		}
-	}
+	tiles.clear();
 
 	//Free loaded images
-	log("killing particle textures...");
+	LOG_INFO("killing particle textures...");
 	gRedTexture.free();
 	gBlueTexture.free();
 	gGreenTexture.free();
 	gShimmerTexture.free();
-	log("killing tile textures...");
+	LOG_INFO("killing tile textures...");
 	gTileTexture.free();
-	log("killing font textures...");
-	gTextCoordinates.free();
-	gTextVelocity.free();
-	gMouseCoordinates.free();
-	gFpsTextTexture.free();
-	log("killing background/mouse textures...");
+	LOG_INFO("killing font textures...");
+	gHudText.free();
+	LOG_INFO("killing background/mouse textures...");
 	gBGTexture.free();
 	gButtonSpriteSheetTexture.free();
+	LOG_INFO("killing cached textures...");
+	std::stringstream cacheStats;
+	cacheStats << "texture cache: " << gTextureCache.getHits() << " hits, " << gTextureCache.getMisses() << " misses, " << gTextureCache.getBytes() << " bytes";
+	LOG_INFO(cacheStats.str());
+	gTextureCache.clear();
 
 	// Free music.
-	log("killing music...");
+	LOG_INFO("killing music...");
 	Mix_FreeMusic(gMusic[1]);
 	gMusic[1] = NULL;
 	Mix_FreeMusic(gMusic[0]);
@@ -290,7 +317,7 @@ void close(Tile *tiles[]) {
 	
 
 	//Destroy window	
-	log("killing window/renderer/font...");
+	LOG_INFO("killing window/renderer/font...");
 	SDL_DestroyRenderer(gRenderer);
 	SDL_DestroyWindow(gWindow);
 	gWindow = NULL;
@@ -298,373 +325,242 @@ void close(Tile *tiles[]) {
 	gFont = NULL;
 
 	//Quit SDL subsystems
-	log("quitting subsystems...");
+	LOG_INFO("quitting subsystems...");
 	Mix_Quit();
 	TTF_Quit();
 	IMG_Quit();
 	SDL_Quit();
 }
 
-bool checkCollision(SDL_Rect a, SDL_Rect b) {
-	//The sides of the rectangles
-	int leftA, leftB;
-	int rightA, rightB;
-	int topA, topB;
-	int bottomA, bottomB;
-
-	//Calculate the sides of rect A
-	leftA = a.x;
-	rightA = a.x + a.w;
-	topA = a.y;
-	bottomA = a.y + a.h;
-
-	//Calculate the sides of rect B
-	leftB = b.x;
-	rightB = b.x + b.w;
-	topB = b.y;
-	bottomB = b.y + b.h;
-
-	//If any of the sides from A are outside of B
-	if(bottomA <= topB) {
-		return false;
-	}
-
-	if(topA >= bottomB) {
-		return false;
-	}
-
-	if(rightA <= leftB) {
-		return false;
+int runHeadless(GameOptions &options, JobSystem &jobs) {
+	// Only the timers, no window or audio so it runs without a display.
+	if(SDL_Init(SDL_INIT_TIMER) < 0) {
+		printf("SDL could not initialize! SDL Error: %s\n", SDL_GetError());
+		return 1;
 	}
-
-	if(leftA >= rightB) {
-		return false;
+	if(!loadConfig() || !gAnimations.load("animations.txt")) {
+		SDL_Quit();
+		return 1;
 	}
+	gAnimations.setFrameTime(gAnimations.findSet("zerowalk.png"), gCharacterFrameRate);
 
-	//If none of the sides from A are outside B
-	return true;
-}
-
-int checkDiagonalCollision(SDL_Rect a, std::vector<SDL_Rect> &b) {
-	//The sides of the rectangles
-	int leftA, leftB;
-	int rightA, rightB;
-	int topA, topB;
-	int bottomA, bottomB;
-
-	//Calculate the sides of rect A
-	leftA = a.x;
-	rightA = a.x + a.w;
-	topA = a.y;
-	bottomA = a.y + a.h;
-
-	//Calculate the sides of rect B
-	for(unsigned bBox = 0; bBox < b.size(); ++bBox) {
-		leftB = b[bBox].x;
-		rightB = b[bBox].x + b[bBox].w;
-		topB = b[bBox].y;
-		bottomB = b[bBox].y + b[bBox].h;
-
-		//If any of the sides from A are outside of B, new way to check collision.
-		if(((bottomA <= topB) || (topA >= bottomB) || (rightA <= leftB) || (leftA >= rightB)) == false) {
-			return bBox;
+	TileMap tileSet;
+	if(!setTiles(tileSet, options.map)) {
+		printf("Failed to load tile set!\n");
+		SDL_Quit();
+		return 1;
+	}
+
+	// Everything random in the world follows from the seed.
+	Random random(options.seed);
+	Character character((int) (37 * gCharacterWidthScale), (int) (48 * gCharacterHeightScale));
+	std::vector<Npc *> npcVector;
+	SpatialHash npcHash;
+	std::vector<NpcHit> npcHits;
+	ParticlePool particles;
+	particles.setSeed(random.next());
+
+	// Spread the npcs over the level, the same way the game does.
+	std::vector<NpcSpawn> npcSpawns;
+	spawnNpcs(tileSet, random, options.npcs, npcSpawns, npcVector);
+
+	float timeStep = 1.f / gSimulationRate;
+
+	Uint64 start = SDL_GetPerformanceCounter();
+	for(int tick = 0; tick < options.ticks; ++tick) {
+		updateNpcs(npcVector, random, tick);
+
+		// Timers run on simulated time, so runs come out the same however fast they go.
+		gClock.advance(timeStep);
+		stepSimulation(tileSet, character, npcVector, npcHash, npcHits, particles, jobs, timeStep);
+		character.interpolate(1);
+	}
+	double seconds = (SDL_GetPerformanceCounter() - start) / (double) SDL_GetPerformanceFrequency();
+
+	printf("%s: %d ticks, %d npcs, %d threads in %.3f s, %.0f ticks/s\n", options.map.c_str(), options.ticks, options.npcs, jobs.getTotalThreads(), seconds, seconds > 0 ? options.ticks / seconds : 0);
+	printf("character at %.2f, %.2f, %u npcs left, %d particles\n", (float) character.getPosX(), (float) character.getPosY(), (unsigned int) npcVector.size(), particles.getSize());
+
+	// Same seed and inputs, same hash, on any machine and thread count.
+	Uint64 hash = 1469598103934665603ull;
+	for(int i = -1; i < (int) npcVector.size(); ++i) {
+		Real state[4];
+		if(i < 0) {
+			state[0] = character.getPosX();
+			state[1] = character.getPosY();
+			state[2] = character.getVelocityX();
+			state[3] = character.getVelocityY();
+		}
+		else {
+			state[0] = npcVector[i]->getPosX();
+			state[1] = npcVector[i]->getPosY();
+			state[2] = npcVector[i]->getVelocityX();
+			state[3] = npcVector[i]->getVelocityY();
+		}
+		const Uint8 *bytes = (const Uint8 *) state;
+		for(unsigned int b = 0; b < sizeof(state); ++b) {
+			hash = (hash ^ bytes[b]) * 1099511628211ull;
 		}
 	}
+	printf("state hash %016llx\n", (unsigned long long) hash);
 
-	//If none of the sides from A are outside B
-	return -1;
-}
-
-bool checkUpperCollision(SDL_Rect a, SDL_Rect b) {
-	//The sides of the rectangles
-	int leftA, leftB;
-	int rightA, rightB;
-	int topA, topB;
-	int bottomA, bottomB;
-
-	//Calculate the sides of rect A
-	leftA = a.x;
-	rightA = a.x + a.w;
-	topA = a.y;
-	bottomA = a.y + a.h;
-
-	//Calculate the sides of rect B
-	leftB = b.x;
-	rightB = b.x + b.w;
-	topB = b.y - 50;
-	bottomB = b.y + b.h;
-
-	//If any of the sides from A are outside of B, old way to check collision.
-	if(bottomA <= topB) {
-		return false;
-	}
-
-	if(topA >= bottomB) {
-		return false;
-	}
-
-	if(rightA <= leftB) {
-		return false;
-	}
-
-	if(leftA >= rightB) {
-		return false;
+	for(unsigned int i = 0; i < npcVector.size(); ++i) {
+		delete npcVector[i];
 	}
-
-	//If none of the sides from A are outside B
-	return true;
+	tileSet.clear();
+	SDL_Quit();
+	return 0;
 }
 
-bool setTiles(Tile *tiles[], std::string mapName) {
-	//Success flag
-	bool tilesLoaded = true;
-
-	//The tile offsets
-	int x = 0, y = 0;
-
-	//Open the map
-	std::ifstream map(mapName);
-
-	//If the map couldn't be loaded
-	if(map == NULL) {
-		printf("Unable to load map file!\n");
-		tilesLoaded = false;
-	}
-	else {
-		//Initialize the tiles
-		for(int i = 0; i < TOTAL_TILES; ++i) {
-			//Determines what kind of tile will be made
-			int tileType = -1;
-
-			//Read tile from map file
-			map >> tileType;
-
-			//If the was a problem in reading the map
-			if(map.fail()) {
-				//Stop loading map
-				printf("Error loading map: Unexpected end of file!\n");
-				tilesLoaded = false;
-				break;
-			}
-
-			//If the number is a valid tile number
-			if((tileType >= 0) && (tileType < TOTAL_TILE_SPRITES)) {
-				tiles[i] = new Tile(x, y, tileType);
-			}
-			//If we don't recognize the tile type
-			else {
-				//Stop loading map
-				printf("Error loading map: Invalid tile type at %d!\n", i);
-				tilesLoaded = false;
-				break;
-			}
-
-			//Move to next tile spot
-			x += TILE_WIDTH;
-
-			//If we've gone too far
-			if(x >= LEVEL_WIDTH) {
-				//Move back
-				x = 0;
-
-				//Move to the next row
-				y += TILE_HEIGHT;
-			}
+int main(int argc, char *args[]) {
+	gLogger.open("log.txt");
+
+	// --headless runs the simulation alone.
+	GameOptions options = {"lazy.map", 100, 10000, 1, -1};
+	for(int i = 1; i < argc; ++i) {
+		std::string option = args[i];
+		bool hasValue = i + 1 < argc;
+		if(option == "--headless") {
+			gHeadless = true;
 		}
-
-		//Clip the sprite sheet
-		if(tilesLoaded) {
-			x = 0; y =0;
-			for(int i = 0; i < TOTAL_TILE_SPRITES / 2; ++i) {
-				gTileClips[i].x = x;
-				gTileClips[i].y = y;
-				gTileClips[i].w = TILE_WIDTH;
-				gTileClips[i].h = TILE_HEIGHT;
-
-				x += TILE_WIDTH;
-				if(x >=  TILESHEET_WIDTH / 2) {
-					x = 0;
-					y += TILE_HEIGHT;
-				}
-			}
-
-			x = TILESHEET_WIDTH / 2;
-			y = 0;
-			for(int i = TOTAL_TILE_SPRITES / 2; i < TOTAL_TILE_SPRITES; ++i) {
-				gTileClips[i].x = x;
-				gTileClips[i].y = y;
-				gTileClips[i].w = TILE_WIDTH;
-				gTileClips[i].h = TILE_HEIGHT;
-
-				x += TILE_WIDTH;
-				if(x >=  TILESHEET_WIDTH) {
-					x = TILESHEET_WIDTH / 2;
-					y += TILE_HEIGHT;
-				}
-			}
-
+		else if(option == "--map" && hasValue) {
+			options.map = args[++i];
 		}
-	}
-
-	//Close the file
-	map.close();
-
-	//If the map was loaded fine
-	return tilesLoaded;
-}
-
-bool touchesTap(SDL_Rect box, Tile *tiles[]) {
-	//Go through the tiles
-	for(int i = 0; i < TOTAL_TILES; ++i) {
-		//If the tile is a wall type tile
-		if(tiles[i]->getType() % 4 != 0 && tiles[i]->getType() < 20) {
-			//If the collision box touches the wall tile
-			if(checkUpperCollision(box, tiles[i]->getBox())) {
-				return true;
-			}
+		else if(option == "--npcs" && hasValue) {
+			options.npcs = atoi(args[++i]);
 		}
-	}
-
-	//If no wall tiles were touched
-	return false;
-}
-
-int touchesWall(SDL_Rect box, Tile *tiles[]) {
-	//Go through the tiles
-	for(int i = 0; i < TOTAL_TILES; ++i) {
-		//If the tile is a wall type tile
-		if((tiles[i]->getType() % 4 != 0 && tiles[i]->getType() < 20) || 
-			 (tiles[i]->getType() % 4 != 0 && tiles[i]->getType() >= 49 && tiles[i]->getType() < 68) ||
-			 (tiles[i]->topHalf) ||
-			 (tiles[i]->diagonalTile)) {
-			//If the collision box touches the wall tile
-			if(tiles[i]->topHalf) {
-				if(checkCollision(box, tiles[i]->getCollisionBox())) {
-					return i;
-				}
-			}
-			else if(tiles[i]->diagonalTile) {
-				int diag = checkDiagonalCollision(box, tiles[i]->getPixelBox());
-				if(diag > -1) {
-					tiles[i]->pixelTouched = diag;
-					return i;
-				}
-			}
-			else {
-				if(checkCollision(box, tiles[i]->getBox())) {
-					return i;
-				}
-			}
+		else if(option == "--ticks" && hasValue) {
+			options.ticks = atoi(args[++i]);
+		}
+		else if(option == "--seed" && hasValue) {
+			options.seed = strtoul(args[++i], NULL, 10);
+		}
+		else if(option == "--threads" && hasValue) {
+			options.threads = atoi(args[++i]);
+		}
+		else if(option == "--record" && hasValue) {
+			options.record = args[++i];
+		}
+		else if(option == "--replay" && hasValue) {
+			options.replay = args[++i];
+		}
+		else if(option == "--fps" && hasValue && (atoi(args[i + 1]) > 0 || std::string(args[i + 1]) == "uncapped" || std::string(args[i + 1]) == "display")) {
+			options.fps = args[++i];
+		}
+		else {
+			printf("usage: %s [--seed number] [--threads count] [--fps number | uncapped | display] [--record file | --replay file] [--headless [--map file] [--npcs count] [--ticks count]]\n", args[0]);
+			gLogger.close();
+			return 1;
 		}
 	}
 
-	//If no wall tiles were touched
-	return -1;
-}
-
-int touchesNpc(SDL_Rect box, std::vector<Npc *> &npcVector) {
-	//Go through the npc
-	for(unsigned int i = 0; i < npcVector.size(); ++i) {
-		if(checkCollision(box, npcVector[i]->getBoxPosition())) {
-			return i;
-		}
+	// Worker threads for the simulation, the calling thread counts as one.
+	JobSystem jobs(options.threads < 0 ? -1 : options.threads - 1);
+	if(gHeadless) {
+		int status = runHeadless(options, jobs);
+		gLogger.close();
+		return status;
 	}
 
-	//If no npc were touched
-	return -1;
-}
+	//Start up SDL and create window
+	LOG_INFO("initializing...");
+	bool configured = loadConfig();
 
-int main(int argc, char *args[]) {
-	
-restart:
+	// The frame rate from the command line wins over config.txt.
+	if(options.fps == "uncapped") {
+		gFrameRate = FRAME_RATE_UNCAPPED;
+	}
+	else if(options.fps == "display") {
+		gFrameRate = FRAME_RATE_DISPLAY;
+	}
+	else if(!options.fps.empty()) {
+		gFrameRate = atoi(options.fps.c_str());
+	}
 
-	logger.open("log.txt");
-	bool restart = false;
-	//Start up SDL and create window
-	log("initializing...");
-	if(!init()) {
+	if(!configured || !init()) {
 		printf("Failed to initialize!\n");
 	}
 	else {
 		//The level tiles
-		Tile *tileSet[TOTAL_TILES];
+		TileMap tileSet;
 
 		//Load media
-		log("loading files...");
+		LOG_INFO("loading files...");
 		if(!loadMedia(tileSet)) {
 			printf("Failed to load media!\n");
 		}
 
 		else {
 
-			log("initializing variables...");
+			LOG_INFO("initializing variables...");
 			//Main loop flag
 			bool quit = false;
 
+			// Play a recorded run back from the same start, or record this one.
+			InputLog inputLog;
+			if(!options.replay.empty()) {
+				if(inputLog.replay(options.replay)) {
+					options.seed = inputLog.getSeed();
+					gSimulationRate = inputLog.getSimulationRate();
+				}
+				else {
+					quit = true;
+				}
+			}
+			else if(!options.record.empty() && !inputLog.record(options.record, options.seed, gSimulationRate)) {
+				quit = true;
+			}
+
 			//Event handler
 			SDL_Event e;
 
 			//The character that will be moving around on the screen
 			Character character((int) (37 * gCharacterWidthScale), (int) (48 * gCharacterHeightScale));
-			character.frameRate = gCharacterFrameRate;
 
 			//vector implementation
 			std::vector<Npc *> npcVector;
-			npcVector.push_back(new Npc(rand() % (LEVEL_WIDTH - (int) (38 * gScale)) + TILE_WIDTH, 0, (int) (38 * gScale), (int) (55 * gScale), 4, "character2.png"));
-			npcVector.push_back(new Npc(rand() % (LEVEL_WIDTH - (int) (38 * gScale)) + TILE_WIDTH, 0, (int) (38 * gScale), (int) (55 * gScale), 4, "character2.png"));
-			npcVector.push_back(new Npc(rand() % (LEVEL_WIDTH - (int) (38 * gScale)) + TILE_WIDTH, 0, (int) (38 * gScale), (int) (55 * gScale), 4, "character3.png"));
-			npcVector.push_back(new Npc(rand() % (LEVEL_WIDTH - (int) (38 * gScale)) + TILE_WIDTH, 0, (int) (38 * gScale), (int) (55 * gScale), 4, "character1.png"));
-			npcVector.push_back(new Npc(rand() % (LEVEL_WIDTH - (int) (76 * gScale)) + TILE_WIDTH, 0, (int) (76 * gScale), (int) (105 * gScale), 4, "character4.png"));
-
-			npcVector[4]->spriteClips[0].x = 0;
-			npcVector[4]->spriteClips[0].y = 0;
-			npcVector[4]->spriteClips[0].w = 76;
-			npcVector[4]->spriteClips[0].h = 105;
-
-			npcVector[4]->spriteClips[1].x = 77;
-			npcVector[4]->spriteClips[1].y = 0;
-			npcVector[4]->spriteClips[1].w = 96;
-			npcVector[4]->spriteClips[1].h = 105;
-
-			npcVector[4]->spriteClips[2].x = 174;
-			npcVector[4]->spriteClips[2].y = 0;
-			npcVector[4]->spriteClips[2].w = 75;
-			npcVector[4]->spriteClips[2].h = 105;
-
-			npcVector[4]->spriteClips[3].x = 250;
-			npcVector[4]->spriteClips[3].y = 0;
-			npcVector[4]->spriteClips[3].w = 96;
-			npcVector[4]->spriteClips[3].h = 105;
-
-			// Timer.
-			LTimer stepTimer;
+
+			//Broadphase over the npc boxes, rebuilt every frame
+			SpatialHash npcHash;
+
+			// What the character did to npcs during a step.
+			std::vector<NpcHit> npcHits;
+
+			// Everything random in the world follows from the seed.
+			Random random(options.seed);
+
+			// Every particle in the level.
+			ParticlePool particles;
+			particles.setSeed(random.next());
+
+			// The npcs the level starts with, spawned again on restart.
+			std::vector<NpcSpawn> npcSpawns;
+			spawnNpcs(tileSet, random, LEVEL_NPCS, npcSpawns, npcVector);
+			Random startRandom = random;
+
+			// Fixed simulation step, and frame time not yet simulated.
+			float timeStep = 1.f / gSimulationRate;
+			float accumulator = 0;
 
 			//Level camera
 			SDL_Rect camera = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
 
-			float avgFPS;
+			float avgFPS = 0;
 			bool toggleParticles = true;
+			bool showProfiler = false;
 			SDL_Color textColor = {136, 0, 21};
 			std::stringstream os;
 
 			std::stringstream timeText;
-			// Frames per second timer.
-			LTimer fpsTimer;
-
-			// Frames per second cap timer.
-			LTimer capTimer;
-
-			// Npc timer.
-			LTimer npcTimer;
+			std::string fpsText;
+			std::string coordinatesText;
+			std::string velocityText;
+			std::string mouseText;
 			LTimer animationTimer;
 			//unsigned int oldTimer = 0;
 
 			// Start timer.
 			int countedFrames = 0;
 
-			// Current animation frame.
-			Uint32 frame = 0;
-
 			// Background scrolling offset.
 			int scrollingOffset = 0;
 
@@ -685,256 +581,282 @@ restart:
 			*/
 
 			int xMouse, yMouse;
-			fpsTimer.start();
-			npcTimer.start();
 			animationTimer.start();
 
-			Uint32 ticks;
-			Uint32 seconds;
+			// Steps simulated so far, recorded input is tied to them.
+			Uint32 simTick = 0;
 
-			log("beginning main loop...");
-			//While application is running
-			while(!quit && !restart) {
+			// Steps since the world started over, the npcs think on them.
+			Uint32 worldTick = 0;
 
-				// introduce lag.
-				//system("./clear.sh");
+			// Input the world reacts to, given live or played back before the step it was recorded at.
+			// Mouse events come with their level position.
+			auto handleInput = [&](SDL_Event &e, int levelX, int levelY) {
+				if(e.type == SDL_QUIT) {
+					quit = true;
+				}
+				// Start over, only the game state is rebuilt.
+				if(e.type == SDL_KEYDOWN && e.key.repeat == 0 && e.key.keysym.sym == SDLK_r) {
+					LOG_INFO("restarting...");
+					resetWorld(tileSet, character, npcVector, npcSpawns, particles, random, startRandom);
+					accumulator = 0;
+					worldTick = 0;
+				}
+				if(e.type == SDL_KEYDOWN && e.key.repeat == 0 && e.key.keysym.sym == SDLK_1) {
+					setTiles(tileSet, "lazy2.map");
+				}
+				if(e.type == SDL_KEYDOWN && e.key.repeat == 0 && e.key.keysym.sym == SDLK_2) {
+					setTiles(tileSet, "lazy.map");
+				}
+				if(e.type == SDL_KEYDOWN && e.key.repeat == 0 && e.key.keysym.sym == SDLK_4) {
+					setTiles(tileSet, "lazy3.map");
+				}
+				if(e.type == SDL_KEYDOWN && e.key.repeat == 0 && e.key.keysym.sym == SDLK_3) {
+					toggleParticles = !toggleParticles;
+					particles.setEnabled(toggleParticles);
+				}
 
-				ticks = SDL_GetTicks();
+				if(e.type == SDL_MOUSEBUTTONDOWN) {
+					os.str("");
+					os << "character" << random.range(4) + 1 << ".png";
+					NpcSpawn spawn = {levelX, levelY, os.str(), random.next()};
+					npcVector.push_back(spawnNpc(spawn));
+				}
 
-				log("in main loop...");
+				// input for the character
+				character.handleEvent(e);
 
-				// Start cap timer.
-				capTimer.start();
+				if(e.type == SDL_KEYDOWN && e.key.repeat == 0 && e.key.keysym.sym == SDLK_q) {
+					if(npcVector.size() != 0) {
+						delete npcVector[npcVector.size() - 1];
+						npcVector.pop_back();
+					}
+				}
+			};
+
+			// Frame pacing, vsync holds the display rate when the renderer has it.
+			FramePacer pacer;
+			if(gFrameRate == FRAME_RATE_DISPLAY) {
+				int refreshRate = DEFAULT_REFRESH_RATE;
+				SDL_DisplayMode mode;
+				if(SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(gWindow), &mode) == 0 && mode.refresh_rate > 0) {
+					refreshRate = mode.refresh_rate;
+				}
+				SDL_RendererInfo info;
+				bool vsync = SDL_GetRendererInfo(gRenderer, &info) == 0 && (info.flags & SDL_RENDERER_PRESENTVSYNC) != 0;
+				pacer.setTargetRate(refreshRate, !vsync);
+			}
+			else {
+				pacer.setTargetRate(gFrameRate, true);
+			}
 
-				//Handle events on queue
+			// Time the frame phases from here on.
+			gProfiler.setEnabled(true);
 
-				log("handling events...");
-				while(SDL_PollEvent(&e) != 0) {
+			LOG_INFO("beginning main loop...");
+			//While application is running
+			while(!quit) {
 
-					//User requests quit
-					if(e.type == SDL_QUIT || e.key.keysym.sym == SDLK_ESCAPE) {
-						quit = true;
-					}
-					if(e.type == SDL_KEYDOWN && e.key.repeat == 0 && e.key.keysym.sym == SDLK_r) {
-						restart = true;
-					}
-					if(e.type == SDL_KEYDOWN && e.key.repeat == 0 && e.key.keysym.sym == SDLK_1) {
-						setTiles(tileSet, "lazy2.map");
-					}
-					if(e.type == SDL_KEYDOWN && e.key.repeat == 0 && e.key.keysym.sym == SDLK_2) {
-						setTiles(tileSet, "lazy.map");
-					}
-					if(e.type == SDL_KEYDOWN && e.key.repeat == 0 && e.key.keysym.sym == SDLK_4) {
-						setTiles(tileSet, "lazy3.map");
-					}
-					if(e.type == SDL_KEYDOWN && e.key.repeat == 0 && e.key.keysym.sym == SDLK_3) {
-						toggleParticles = !toggleParticles;
-					}
+				// introduce lag.
+				//system("./clear.sh");
 
-					// Handle button events.
-					for(int i = 0; i < TOTAL_BUTTONS; ++i) {
-						gButtons[i].handleEvent(&e);
-					}
+				// The one time sample of the frame, every timer reads it.
+				gClock.tick();
+
+				LOG_DEBUG("in main loop...");
+
+				//Handle events on queue
 
-					if(e.type == SDL_MOUSEBUTTONDOWN) {
-						os.str("");
-						int random = rand() % 4 + 1;
-						os << "character" << random << ".png";
-						if(random == 4) {
-							npcVector.push_back(new Npc(camera.x + xMouse, camera.y + yMouse, (int)(76 * gScale), (int)(105 * gScale), 4, os.str()));
-
-							npcVector[npcVector.size() - 1]->spriteClips[0].x = 0;
-							npcVector[npcVector.size() - 1]->spriteClips[0].y = 0;
-							npcVector[npcVector.size() - 1]->spriteClips[0].w = 76;
-							npcVector[npcVector.size() - 1]->spriteClips[0].h = 105;
-
-							npcVector[npcVector.size() - 1]->spriteClips[1].x = 77;
-							npcVector[npcVector.size() - 1]->spriteClips[1].y = 0;
-							npcVector[npcVector.size() - 1]->spriteClips[1].w = 96;
-							npcVector[npcVector.size() - 1]->spriteClips[1].h = 105;
-
-							npcVector[npcVector.size() - 1]->spriteClips[2].x = 174;
-							npcVector[npcVector.size() - 1]->spriteClips[2].y = 0;
-							npcVector[npcVector.size() - 1]->spriteClips[2].w = 75;
-							npcVector[npcVector.size() - 1]->spriteClips[2].h = 105;
-
-							npcVector[npcVector.size() - 1]->spriteClips[3].x = 250;
-							npcVector[npcVector.size() - 1]->spriteClips[3].y = 0;
-							npcVector[npcVector.size() - 1]->spriteClips[3].w = 96;
-							npcVector[npcVector.size() - 1]->spriteClips[3].h = 105;
+				LOG_DEBUG("handling events...");
+				{
+					PROFILE_ZONE("event polling");
+					while(SDL_PollEvent(&e) != 0) {
+
+						//User requests quit, a recording ends here too
+						if(e.type == SDL_QUIT || e.key.keysym.sym == SDLK_ESCAPE) {
+							quit = true;
+							SDL_Event quitEvent;
+							quitEvent.type = SDL_QUIT;
+							inputLog.write(simTick, quitEvent, 0, 0);
 						}
-						else {
-							npcVector.push_back(new Npc(camera.x + xMouse, camera.y + yMouse, (int) (gScale * 38), (int) (gScale * 55), 4, os.str()));
+						// Render target contents were lost, redraw the cached tiles.
+						if(e.type == SDL_RENDER_TARGETS_RESET) {
+							tileSet.invalidate();
+						}
+						// Profiler overlay, and a trace of the next frames.
+						if(e.type == SDL_KEYDOWN && e.key.repeat == 0 && e.key.keysym.sym == SDLK_F1) {
+							showProfiler = !showProfiler;
+						}
+						if(e.type == SDL_KEYDOWN && e.key.repeat == 0 && e.key.keysym.sym == SDLK_F2 && !gProfiler.isCapturing()) {
+							LOG_INFO("capturing trace...");
+							gProfiler.captureTrace("trace.json", PROFILE_TRACE_FRAMES);
+						}
+						// Pause, and slow down or speed up game time.
+						if(e.type == SDL_KEYDOWN && e.key.repeat == 0 && e.key.keysym.sym == SDLK_p) {
+							gClock.setPaused(!gClock.isPaused());
+						}
+						if(e.type == SDL_KEYDOWN && e.key.repeat == 0 && e.key.keysym.sym == SDLK_MINUS && gClock.getTimeScale() > MIN_TIME_SCALE) {
+							gClock.setTimeScale(gClock.getTimeScale() / 2);
+						}
+						if(e.type == SDL_KEYDOWN && e.key.repeat == 0 && e.key.keysym.sym == SDLK_EQUALS && gClock.getTimeScale() < MAX_TIME_SCALE) {
+							gClock.setTimeScale(gClock.getTimeScale() * 2);
 						}
-					}
 
-					// input for the character
-					character.handleEvent(e);
+						// Handle button events.
+						for(int i = 0; i < TOTAL_BUTTONS; ++i) {
+							gButtons[i].handleEvent(&e);
+						}
 
-					if(e.type == SDL_KEYDOWN && e.key.repeat == 0 && e.key.keysym.sym == SDLK_q) {
-						if(npcVector.size() != 0) {
-							delete npcVector[npcVector.size() - 1];
-							npcVector.pop_back();
+						// The keyboard and mouse drive the world unless a recording does.
+						bool mouse = e.type == SDL_MOUSEBUTTONDOWN || e.type == SDL_MOUSEBUTTONUP;
+						if(!inputLog.isReplaying() && (e.type == SDL_KEYDOWN || e.type == SDL_KEYUP || mouse)) {
+							int levelX = mouse ? camera.x + e.button.x : 0;
+							int levelY = mouse ? camera.y + e.button.y : 0;
+							inputLog.write(simTick, e, levelX, levelY);
+							handleInput(e, levelX, levelY);
 						}
 					}
 				}
 
-				// Calculate time step.
-				float timeStep = stepTimer.getTicks() / 1000.f; //1.0;
-
-				if(character.headJump == true) {
-					character.setVelocityY(0);
-					character.setVelocityY(-character.CHARACTER_VELY);
-					character.headJump = false;
-				}
-
-				seconds = ticks / 1000.f;
-				if(seconds % 10 == 0) {
-					logger.close();
-					logger.open("log.txt");
+				// Add the frame time, dropping what a long hitch would make us catch up on.
+				accumulator += gClock.getFrameTime();
+				if(accumulator > MAX_FRAME_TIME) {
+					accumulator = MAX_FRAME_TIME;
 				}
 
 				// Calculate and correct fps.
-				avgFPS = countedFrames / (fpsTimer.getTicks() / 1000.f);
+				avgFPS = countedFrames / gClock.getRealTime();
 				if(avgFPS > 2000000) avgFPS = 0;
 
-				// FPS text.
+				// FPS text, and how game time runs when not as usual.
 				timeText.str("");
 				timeText << "FPS: " << avgFPS;
-				if(!gFpsTextTexture.loadFromRenderedText(timeText.str().c_str(), textColor)) {
-					printf("unable to render FPS texture\n");
+				if(pacer.getMissedFrames() > 0) {
+					timeText << " (" << pacer.getMissedFrames() << " late)";
 				}
-
-				
-				// Handle pushback attack collision.
-				for(unsigned int i = 0; i < npcVector.size(); ++i) {
-					if(npcVector[i]->wasStabbed) {
-						if(npcVector[i]->wasAttackedTimer.getTicks() > 100) {
-							npcVector[i]->setVelocityX(0);
-							npcVector[i]->wasStabbed = false;
-							npcVector[i]->wasAttackedTimer.stop();
-						}
-					}
+				if(gClock.isPaused()) {
+					timeText << " paused";
 				}
-
-				// AI.
-				if((npcTimer.getTicks() / 1000) != 0 && (npcTimer.getTicks() / 1000) % 2  == 0) {
-					for(unsigned int i = 0; i < npcVector.size(); ++i) {
-						if(!npcVector[i]->wasStabbed) {
-							switch(rand() % 3) {
-								case 0:
-									npcVector[i]->isMoving = true;
-									npcVector[i]->setVelocityX(-npcVector[i]->NPC_VELX);
-									npcVector[i]->flip = SDL_FLIP_NONE;
-									break;
-								case 1:
-									npcVector[i]->isMoving = true;
-									npcVector[i]->setVelocityX(npcVector[i]->NPC_VELX);
-									npcVector[i]->flip = SDL_FLIP_HORIZONTAL;
-									break;
-								case 2:
-									npcVector[i]->isMoving = false;
-									npcVector[i]->setVelocityX(0);
-									break;
-								default:
-									break;
-							}
-						}
-					}
-					npcTimer.start();
+				else if(gClock.getTimeScale() != 1) {
+					timeText << " x" << gClock.getTimeScale();
 				}
+				fpsText = timeText.str();
+
 
         // Whole screen viewport.
         //SDL_RenderSetViewport(gRenderer, &wholeScreenViewport);
 
-				//Move the character.
-				log("moving character...");
-				character.move(tileSet, npcVector, timeStep /*1 for now*/);
+				// Run as many fixed steps as the frame time covers, none once quitting so a replay ends on the recorded step.
+				LOG_DEBUG("moving character...");
+				while(!quit && accumulator >= timeStep) {
+					// Played back input goes in before the step it was recorded at.
+					int levelX, levelY;
+					while(inputLog.isReplaying() && inputLog.read(simTick, e, levelX, levelY)) {
+						handleInput(e, levelX, levelY);
+					}
+					if(quit) {
+						break;
+					}
+
+					// AI.
+					{
+						PROFILE_ZONE("ai");
 
-				// Restart step timer.
-				stepTimer.start();
-				
-				for(unsigned int i = 0; i < npcVector.size(); ++i) {
-					npcVector[i]->move(tileSet, character, timeStep /*1 for now*/);
-					if(npcVector[i]->wasJumped) {
-						delete npcVector[i];
-						npcVector.erase(npcVector.begin() + i);
+						// Handle pushback attack collision and pick where to walk.
+						updateNpcs(npcVector, random, worldTick);
 					}
-					//if(npcVector[i]->wasStabbed) {
-						//npcVector[i]->setVelocityX(15 * 60);
-					//}
+
+					stepSimulation(tileSet, character, npcVector, npcHash, npcHits, particles, jobs, timeStep);
+					++simTick;
+					++worldTick;
+					accumulator -= timeStep;
 				}
 
-				log("setting camera...");
-				character.setCamera(camera);
+				// A recording without its quit ends after its last event.
+				if(inputLog.isReplaying() && inputLog.isFinished()) {
+					quit = true;
+				}
 
-				// Scroll background.
-				--scrollingOffset;
-				if(scrollingOffset < -gBGTexture.getWidth()) {
-					scrollingOffset = 0;
+				// Draw between the last two steps by the time left over.
+				float alpha = accumulator / timeStep;
+				character.interpolate(alpha);
+				for(unsigned int i = 0; i < npcVector.size(); ++i) {
+					npcVector[i]->interpolate(alpha);
 				}
 
-				log("preparing font info...");
-				os.str("");
-				os << character.getBoxPosition().x << ", " << character.getBoxPosition().y;
-				if(!gTextCoordinates.loadFromRenderedText(os.str().c_str(), textColor)) {
-					log("error!");
-					printf("failed to render text texture\n");
+				LOG_DEBUG("setting camera...");
+				{
+					PROFILE_ZONE("camera");
+					character.setCamera(camera, tileSet);
 				}
 
-				os.str("");
-				os << character.getVelocityX() << ", " << (int) character.getVelocityY();
-				if(!gTextVelocity.loadFromRenderedText(os.str().c_str(), textColor)) {
-					log("error!");
-					printf("failed to render text texture\n");
+				// Scroll background.
+				--scrollingOffset;
+				if(scrollingOffset < -gBGTexture.getWidth()) {
+					scrollingOffset = 0;
 				}
 
-				os.str("");
-				SDL_GetMouseState(&xMouse, &yMouse);
-				os << xMouse << ", " << yMouse << ": " << npcVector.size();
-				if(!gMouseCoordinates.loadFromRenderedText(os.str().c_str(), textColor)) {
-					log("error!");
-					printf("failed to render text texture\n");
+				LOG_DEBUG("preparing font info...");
+				{
+					PROFILE_ZONE("hud text");
+					os.str("");
+					os << character.getBoxPosition().x << ", " << character.getBoxPosition().y;
+					coordinatesText = os.str();
+
+					os.str("");
+					os << (float) character.getVelocityX() << ", " << (int) character.getVelocityY();
+					velocityText = os.str();
+
+					os.str("");
+					SDL_GetMouseState(&xMouse, &yMouse);
+					os << xMouse << ", " << yMouse << ": " << npcVector.size();
+					mouseText = os.str();
 				}
 
-				log("clearing screen...");
+				LOG_DEBUG("clearing screen...");
 				//Clear screen
 				SDL_SetRenderDrawColor(gRenderer, 0xFF, 0xFF, 0xFF, 0xFF);
 				SDL_RenderClear(gRenderer);
 
-				gBGTexture.render(scrollingOffset, 0);
-				gBGTexture.render(scrollingOffset + gBGTexture.getWidth(), 0);
+				{
+					PROFILE_ZONE("background render");
+					gBGTexture.render(scrollingOffset, 0);
+					gBGTexture.render(scrollingOffset + gBGTexture.getWidth(), 0);
+				}
 
 				//Render level
-				log("rendering level...");
-				for(int i = 0; i < TOTAL_TILES; ++i) {
-					tileSet[i]->render(camera);
+				LOG_DEBUG("rendering level...");
+				{
+					PROFILE_ZONE("tile render");
+					tileSet.render(camera);
 				}
 
 				// Render font.
-				log("rendering font...");
-				gTextCoordinates.render((SCREEN_WIDTH - gTextCoordinates.getWidth()),  0);
-				gTextVelocity.render((SCREEN_WIDTH - gTextVelocity.getWidth()),  30);
-				gFpsTextTexture.render((SCREEN_WIDTH - gFpsTextTexture.getWidth()),  60);
-				gMouseCoordinates.render((SCREEN_WIDTH - gMouseCoordinates.getWidth()),  90);
+				LOG_DEBUG("rendering font...");
+				{
+					PROFILE_ZONE("hud text");
+					gHudText.render(SCREEN_WIDTH - gHudText.getWidth(coordinatesText.c_str()), 0, coordinatesText.c_str(), textColor);
+					gHudText.render(SCREEN_WIDTH - gHudText.getWidth(velocityText.c_str()), 30, velocityText.c_str(), textColor);
+					gHudText.render(SCREEN_WIDTH - gHudText.getWidth(fpsText.c_str()), 60, fpsText.c_str(), textColor);
+					gHudText.render(SCREEN_WIDTH - gHudText.getWidth(mouseText.c_str()), 90, mouseText.c_str(), textColor);
+				}
 
-				log("rendering character...");
-				character.render(camera, toggleParticles, gCharacterWidthScale, gCharacterHeightScale);
+				LOG_DEBUG("rendering character...");
+				{
+					PROFILE_ZONE("character render");
+					character.render(camera, gCharacterWidthScale, gCharacterHeightScale);
 
-				log("rendering npc...");
+					// Particles on top of the character.
+					particles.render(camera);
+				}
 
-				//NPC frame.
-				frame = (ticks / 100) % 4;
-				
-				for(unsigned int i = 0; i < npcVector.size(); ++i) {
-					if(npcVector[i]->isMoving || npcVector[i]->NPC_HEIGHT == (int)(105 * gScale)) {
-						npcVector[i]->currentClip = &npcVector[i]->spriteClips[frame];
-					}
-					else { 
-						npcVector[i]->currentClip = &npcVector[i]->spriteClips[1]; 
+				LOG_DEBUG("rendering npc...");
+				{
+					PROFILE_ZONE("npc render");
+
+					for(unsigned int i = 0; i < npcVector.size(); ++i) {
+						npcVector[i]->render(camera, toggleParticles, gScale);
 					}
-					if(npcVector[i]->NPC_HEIGHT == (int)(105 * gScale)) npcVector[i]->render(camera, toggleParticles, npcVector[i]->currentClip, gScale);
-					else npcVector[i]->render(camera, toggleParticles, npcVector[i]->currentClip, gScale);
 				}
 				
         //SDL_RenderSetViewport(gRenderer, &topLeftViewport);
@@ -943,26 +865,44 @@ restart:
 					gButtons[i].render();
 				}
 
-				log("updating screen...");
+				// Zone times of the last frames.
+				if(showProfiler) {
+					gProfiler.render(gHudText, 0, 0, textColor);
+				}
+
+				LOG_DEBUG("updating screen...");
 				//Update screen
-				SDL_RenderPresent(gRenderer);
+				{
+					PROFILE_ZONE("present");
+					SDL_RenderPresent(gRenderer);
+				}
 				++countedFrames;
 
-				// If frame time finished early.
-				int frameTicks = capTimer.getTicks();
-				if(frameTicks < SCREEN_TICKS_PER_FRAME) {
-					// Wait remaining time.
-					SDL_Delay(SCREEN_TICKS_PER_FRAME - frameTicks);
+				// Wait for the next frame, unless vsync already did.
+				{
+					PROFILE_ZONE("frame pacing");
+					pacer.wait();
 				}
 
-				log("end loop...");
+				// Hand this frame's zones to the overlay and any trace.
+				gProfiler.endFrame();
+
+				LOG_DEBUG("end loop...");
+			}
+
+			if(inputLog.isReplaying()) {
+				printf("replayed %s: %u steps, %d frames at %.1f fps, %d late\n", options.replay.c_str(), simTick, countedFrames, avgFPS, pacer.getMissedFrames());
 			}
+			std::stringstream paceStats;
+			paceStats << "frames: " << pacer.getFrames() << " at " << pacer.getTargetRate() << " per second, " << pacer.getMissedFrames() << " late";
+			LOG_INFO(paceStats.str());
+			inputLog.close();
 
-			if(quit) log("quit");
-			else log("false");
+			if(quit) LOG_DEBUG("quit");
+			else LOG_DEBUG("false");
 
-			log("freeing...");
-			character.characterTexture.free();
+			LOG_INFO("freeing...");
+			character.characterTexture.reset();
 			/*
 			for(int i = 0; i < contained; ++i) {
 				delete npcContainer[i];
@@ -976,13 +916,12 @@ restart:
 		}
 
 		//Free resources and close SDL
-		log("closing...");
+		LOG_INFO("closing...");
 		close(tileSet);
-		log("after...");
-		if(restart) goto restart;
+		LOG_INFO("after...");
 	}
 
-	log("shutdown...");
-	logger.close();
+	LOG_INFO("shutdown...");
+	gLogger.close();
 	return 0;
 }
@@ -0,0 +1,43 @@
+#ifndef RANDOM_HPP
+	#define RANDOM_HPP
+#include <SDL.h>
+
+//PCG32 generator, the same sequence for a seed on every machine
+//Each world owns one and hands it to what needs random numbers, nothing in the simulation calls rand()
+class Random {
+	public:
+		Random(Uint64 seed = 1) {
+			setSeed(seed);
+		}
+
+		//Restarts the sequence
+		void setSeed(Uint64 seed) {
+			mState = 0;
+			mIncrement = (STREAM << 1) | 1;
+			next();
+			mState += seed;
+			next();
+		}
+
+		//Uniform over every Uint32
+		inline Uint32 next() {
+			Uint64 old = mState;
+			mState = old * MULTIPLIER + mIncrement;
+			Uint32 shifted = (Uint32) (((old >> 18) ^ old) >> 27);
+			Uint32 rotation = (Uint32) (old >> 59);
+			return (shifted >> rotation) | (shifted << ((-rotation) & 31));
+		}
+
+		//Uniform in [0, count)
+		inline int range(int count) {
+			return (int) (((Uint64) next() * (Uint32) count) >> 32);
+		}
+
+	private:
+		static const Uint64 MULTIPLIER = 6364136223846793005ull;
+		static const Uint64 STREAM = 0xda3e39cb94b95bdbull;
+
+		Uint64 mState;
+		Uint64 mIncrement;
+};
+#endif
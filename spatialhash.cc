@@ -0,0 +1,139 @@
+#include "spatialhash.hpp"
+#include <algorithm>
+
+//Divides rounding towards negative infinity
+static int floorDiv(int a, int b) {
+	return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+SpatialHash::SpatialHash(int cellSize, int totalBuckets) {
+	mCellSize = cellSize;
+
+	//Round the bucket count up to a power of two so hashing is a mask
+	mTotalBuckets = 1;
+	while(mTotalBuckets < totalBuckets) {
+		mTotalBuckets *= 2;
+	}
+	mBuckets.resize(mTotalBuckets);
+
+	mSize = 0;
+	mStamp = 0;
+}
+
+void SpatialHash::clear() {
+	for(unsigned i = 0; i < mUsedBuckets.size(); ++i) {
+		Bucket &bucket = mBuckets[mUsedBuckets[i]];
+		bucket.cellX.clear();
+		bucket.cellY.clear();
+		bucket.ids.clear();
+		bucket.boxes.clear();
+	}
+	mUsedBuckets.clear();
+	mSize = 0;
+}
+
+void SpatialHash::getCellRange(SDL_Rect box, int &firstX, int &firstY, int &lastX, int &lastY) {
+	//Empty boxes still overlap boxes around them, so give them the cell they sit in
+	firstX = floorDiv(box.x, mCellSize);
+	firstY = floorDiv(box.y, mCellSize);
+	lastX = floorDiv(box.x + std::max(box.w, 1) - 1, mCellSize);
+	lastY = floorDiv(box.y + std::max(box.h, 1) - 1, mCellSize);
+}
+
+void SpatialHash::insert(int id, SDL_Rect box) {
+	if(id >= (int) mMarks.size()) {
+		mMarks.resize(id + 1, 0);
+	}
+	++mSize;
+
+	//Add the box to every cell it covers
+	int firstX, firstY, lastX, lastY;
+	getCellRange(box, firstX, firstY, lastX, lastY);
+	for(int cellY = firstY; cellY <= lastY; ++cellY) {
+		for(int cellX = firstX; cellX <= lastX; ++cellX) {
+			Bucket &bucket = mBuckets[getBucket(cellX, cellY)];
+			if(bucket.ids.empty()) {
+				mUsedBuckets.push_back(getBucket(cellX, cellY));
+			}
+
+			bucket.cellX.push_back(cellX);
+			bucket.cellY.push_back(cellY);
+			bucket.ids.push_back(id);
+			bucket.boxes.push(box);
+		}
+	}
+}
+
+void SpatialHash::testBucket(SDL_Rect box, Bucket &bucket) {
+	if(mMask.size() < (bucket.ids.size() + 31) / 32) {
+		mMask.resize((bucket.ids.size() + 31) / 32);
+	}
+	overlapMask(box, bucket.boxes, &mMask[0]);
+}
+
+void SpatialHash::query(SDL_Rect box, std::vector<int> &ids) {
+	ids.clear();
+
+	//New stamp, wiping the marks when it wraps around
+	if(++mStamp == 0) {
+		std::fill(mMarks.begin(), mMarks.end(), 0);
+		mStamp = 1;
+	}
+
+	int firstX, firstY, lastX, lastY;
+	getCellRange(box, firstX, firstY, lastX, lastY);
+	for(int cellY = firstY; cellY <= lastY; ++cellY) {
+		for(int cellX = firstX; cellX <= lastX; ++cellX) {
+			Bucket &bucket = mBuckets[getBucket(cellX, cellY)];
+			if(bucket.ids.empty()) {
+				continue;
+			}
+
+			testBucket(box, bucket);
+			for(unsigned i = 0; i < bucket.ids.size(); ++i) {
+				//Skip misses, other cells sharing the bucket and boxes already found
+				if((mMask[i >> 5] & (1u << (i & 31))) == 0 || bucket.cellX[i] != cellX || bucket.cellY[i] != cellY) {
+					continue;
+				}
+				int id = bucket.ids[i];
+				if(mMarks[id] != mStamp) {
+					mMarks[id] = mStamp;
+					ids.push_back(id);
+				}
+			}
+		}
+	}
+
+	std::sort(ids.begin(), ids.end());
+}
+
+int SpatialHash::queryFirst(SDL_Rect box) {
+	int first = -1;
+
+	int firstX, firstY, lastX, lastY;
+	getCellRange(box, firstX, firstY, lastX, lastY);
+	for(int cellY = firstY; cellY <= lastY; ++cellY) {
+		for(int cellX = firstX; cellX <= lastX; ++cellX) {
+			Bucket &bucket = mBuckets[getBucket(cellX, cellY)];
+			if(bucket.ids.empty()) {
+				continue;
+			}
+
+			testBucket(box, bucket);
+			for(unsigned i = 0; i < bucket.ids.size(); ++i) {
+				if((mMask[i >> 5] & (1u << (i & 31))) == 0 || bucket.cellX[i] != cellX || bucket.cellY[i] != cellY) {
+					continue;
+				}
+				if(first == -1 || bucket.ids[i] < first) {
+					first = bucket.ids[i];
+				}
+			}
+		}
+	}
+
+	return first;
+}
+
+int SpatialHash::getSize() {
+	return mSize;
+}
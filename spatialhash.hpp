@@ -0,0 +1,64 @@
+#ifndef SPATIALHASH_HPP
+	#define SPATIALHASH_HPP
+#include <SDL.h>
+#include <vector>
+#include "aabb.hpp"
+
+//Hashes boxes into square cells so rect queries only look at nearby boxes
+class SpatialHash {
+	public:
+		//Initializes an empty hash
+		SpatialHash(int cellSize = 128, int totalBuckets = 1024);
+
+		//Removes every box, keeping the memory for the next rebuild
+		void clear();
+
+		//Adds a box under an id
+		void insert(int id, SDL_Rect box);
+
+		//Gets the ids of all boxes overlapping a box, in ascending order
+		void query(SDL_Rect box, std::vector<int> &ids);
+
+		//Gets the lowest id overlapping a box, -1 if none
+		int queryFirst(SDL_Rect box);
+
+		int getSize();
+
+	private:
+		//Entries of the cells hashing to one bucket, boxes kept apart for the overlap kernel
+		struct Bucket {
+			std::vector<int> cellX;
+			std::vector<int> cellY;
+			std::vector<int> ids;
+			BoxArray boxes;
+		};
+
+		//Tests a box against a bucket, leaving the hits in mMask
+		void testBucket(SDL_Rect box, Bucket &bucket);
+
+		//Gets the cells overlapped by a box
+		void getCellRange(SDL_Rect box, int &firstX, int &firstY, int &lastX, int &lastY);
+
+		//Gets the bucket a cell hashes to
+		inline int getBucket(int cellX, int cellY) {
+			return (int) (((unsigned) cellX * 73856093u) ^ ((unsigned) cellY * 19349663u)) & (mTotalBuckets - 1);
+		}
+
+		int mCellSize;
+		int mTotalBuckets;
+
+		//Number of boxes inserted
+		int mSize;
+
+		//Entries per bucket, and the buckets that need clearing
+		std::vector<Bucket> mBuckets;
+		std::vector<int> mUsedBuckets;
+
+		//Overlap bits of the last bucket tested
+		std::vector<Uint32> mMask;
+
+		//Query stamp per id, so boxes spanning several cells are reported once
+		std::vector<unsigned> mMarks;
+		unsigned mStamp;
+};
+#endif
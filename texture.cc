@@ -18,36 +18,37 @@ bool LTexture::loadFromFile(std::string path) {
 	//Get rid of preexisting texture
 	free();
 
-	//The final texture
-	SDL_Texture *newTexture = NULL;
-
 	//Load image at specified path
 	SDL_Surface *loadedSurface = IMG_Load(path.c_str());
 	if(loadedSurface == NULL) {
 		printf("Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError());
+		return false;
 	}
-	else {
-		//Color key image
-		SDL_SetColorKey(loadedSurface, SDL_TRUE, SDL_MapRGB(loadedSurface->format, 0, 255, 255));
+	bool loaded = loadFromSurface(loadedSurface, path);
 
-		//Create texture from surface pixels
-		newTexture = SDL_CreateTextureFromSurface(gRenderer, loadedSurface);
-		if(newTexture == NULL) {
-			printf("Unable to create texture from %s! SDL Error: %s\n", path.c_str(), SDL_GetError());
-		}
-		else {
-			//Get image dimensions
-			mWidth = loadedSurface->w;
-			mHeight = loadedSurface->h;
-		}
+	//Get rid of old loaded surface
+	SDL_FreeSurface(loadedSurface);
+	return loaded;
+}
+
+bool LTexture::loadFromSurface(SDL_Surface *surface, std::string path) {
+	//Get rid of preexisting texture
+	free();
 
-		//Get rid of old loaded surface
-		SDL_FreeSurface(loadedSurface);
+	//Color key image
+	SDL_SetColorKey(surface, SDL_TRUE, SDL_MapRGB(surface->format, 0, 255, 255));
+
+	//Create texture from surface pixels
+	mTexture = SDL_CreateTextureFromSurface(gRenderer, surface);
+	if(mTexture == NULL) {
+		printf("Unable to create texture from %s! SDL Error: %s\n", path.c_str(), SDL_GetError());
+		return false;
 	}
 
-	//Return success
-	mTexture = newTexture;
-	return mTexture != NULL;
+	//Get image dimensions
+	mWidth = surface->w;
+	mHeight = surface->h;
+	return true;
 }
 
 bool LTexture::loadFromRenderedText(std::string textureText, SDL_Color textColor) {
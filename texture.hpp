@@ -15,6 +15,9 @@ class LTexture {
 		//Loads image at specified path
 		bool loadFromFile(std::string path);
 
+		//Creates image from a decoded surface, which the caller still frees
+		bool loadFromSurface(SDL_Surface *surface, std::string path);
+
 		//Creates image from font string
 		bool loadFromRenderedText(std::string textureText, SDL_Color textColor);
 
@@ -0,0 +1,84 @@
+#include "texturecache.hpp"
+
+//Four bytes per pixel once uploaded
+static long textureBytes(LTexture &texture) {
+	return (long) texture.getWidth() * texture.getHeight() * 4;
+}
+
+TextureCache::TextureCache() {
+	mHits = 0;
+	mMisses = 0;
+	mBytes = 0;
+}
+
+std::shared_ptr<LTexture> TextureCache::load(std::string path) {
+	std::map<std::string, std::shared_ptr<LTexture> >::iterator found = mTextures.find(path);
+	if(found != mTextures.end()) {
+		++mHits;
+		return found->second;
+	}
+
+	//Failures are cached as empty handles, so a missing sheet is only tried once
+	++mMisses;
+	std::shared_ptr<LTexture> texture(new LTexture());
+	if(!texture->loadFromFile(path)) {
+		mTextures[path] = std::shared_ptr<LTexture>();
+		return mTextures[path];
+	}
+
+	mBytes += textureBytes(*texture);
+	mTextures[path] = texture;
+	return texture;
+}
+
+std::shared_ptr<LTexture> TextureCache::insert(std::string path, SDL_Surface *surface) {
+	++mMisses;
+	std::shared_ptr<LTexture> texture(new LTexture());
+	if(!texture->loadFromSurface(surface, path)) {
+		return std::shared_ptr<LTexture>();
+	}
+
+	//Replaces any texture already cached for path, holders keep the old one
+	std::map<std::string, std::shared_ptr<LTexture> >::iterator found = mTextures.find(path);
+	if(found != mTextures.end() && found->second) {
+		mBytes -= textureBytes(*found->second);
+	}
+	mBytes += textureBytes(*texture);
+	mTextures[path] = texture;
+	return texture;
+}
+
+void TextureCache::purge() {
+	std::map<std::string, std::shared_ptr<LTexture> >::iterator i = mTextures.begin();
+	while(i != mTextures.end()) {
+		//Only the cache holds it
+		if(i->second.use_count() == 1) {
+			mBytes -= textureBytes(*i->second);
+			mTextures.erase(i++);
+		}
+		else {
+			++i;
+		}
+	}
+}
+
+void TextureCache::clear() {
+	mTextures.clear();
+	mBytes = 0;
+}
+
+int TextureCache::getHits() {
+	return mHits;
+}
+
+int TextureCache::getMisses() {
+	return mMisses;
+}
+
+long TextureCache::getBytes() {
+	return mBytes;
+}
+
+int TextureCache::getSize() {
+	return (int) mTextures.size();
+}
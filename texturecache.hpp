@@ -0,0 +1,42 @@
+#ifndef TEXTURECACHE_HPP
+	#define TEXTURECACHE_HPP
+#include <string>
+#include <map>
+#include <memory>
+#include "texture.hpp"
+
+//Textures keyed by path, shared between everything that loads the same file
+class TextureCache {
+	public:
+		//Initializes an empty cache
+		TextureCache();
+
+		//Gets the texture at path, loading it the first time, NULL if it failed to load, which is only tried once until clear
+		std::shared_ptr<LTexture> load(std::string path);
+
+		//Uploads an image decoded elsewhere, later loads of path are served from the cache
+		std::shared_ptr<LTexture> insert(std::string path, SDL_Surface *surface);
+
+		//Frees textures nobody holds anymore
+		void purge();
+
+		//Frees every texture, handles still held keep theirs alive
+		void clear();
+
+		//Loads served from the cache and from disk
+		int getHits();
+		int getMisses();
+
+		//Estimated size of the cached textures
+		long getBytes();
+
+		int getSize();
+
+	private:
+		std::map<std::string, std::shared_ptr<LTexture> > mTextures;
+
+		int mHits;
+		int mMisses;
+		long mBytes;
+};
+#endif
@@ -0,0 +1,463 @@
+#include "tilemap.hpp"
+#include "logger.hpp"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//Level file records are used as tiles
+static_assert(sizeof(Tile) == sizeof(MapTile), "Tile must match the level file records");
+
+//Divides rounding towards negative infinity
+static int floorDiv(int a, int b) {
+	return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+//Gets the cells of a grid overlapped by a box grown by margin cells, returns false if it misses the grid
+static bool getGridRange(SDL_Rect &box, int cellWidth, int cellHeight, int margin, int columns, int rows, int &firstColumn, int &firstRow, int &lastColumn, int &lastRow) {
+	//Boxes only touching a cell edge do not overlap it
+	firstColumn = floorDiv(box.x, cellWidth) - margin;
+	firstRow = floorDiv(box.y, cellHeight) - margin;
+	lastColumn = floorDiv(box.x + box.w - 1, cellWidth) + margin;
+	lastRow = floorDiv(box.y + box.h - 1, cellHeight) + margin;
+
+	//Keep the range inside the grid
+	if(firstColumn < 0) firstColumn = 0;
+	if(firstRow < 0) firstRow = 0;
+	if(lastColumn >= columns) lastColumn = columns - 1;
+	if(lastRow >= rows) lastRow = rows - 1;
+
+	return firstColumn <= lastColumn && firstRow <= lastRow;
+}
+
+TileMap::TileMap() {
+	mColumns = 0;
+	mRows = 0;
+	mChunkColumns = 0;
+	mChunkRows = 0;
+	mFileTiles = NULL;
+	mMapping = NULL;
+	mMappingSize = 0;
+	mLayerColumns = 0;
+	mLayerRows = 0;
+	mLayersFailed = false;
+}
+
+TileMap::~TileMap() {
+	clear();
+}
+
+void TileMap::reset(int columns, int rows) {
+	clear();
+	mColumns = columns;
+	mRows = rows;
+	mChunkColumns = (mColumns + LEVEL_CHUNK_SIZE - 1) >> LEVEL_CHUNK_SHIFT;
+	mChunkRows = (mRows + LEVEL_CHUNK_SIZE - 1) >> LEVEL_CHUNK_SHIFT;
+
+	//Nothing to load them from, so every chunk stays in memory
+	int totalChunks = mChunkColumns * mChunkRows;
+	mChunkMemory.assign(totalChunks * LEVEL_CHUNK_TILES, Tile());
+	mChunks.resize(totalChunks);
+	mChunkPending.assign(totalChunks, 0);
+	for(int i = 0; i < totalChunks; ++i) {
+		mChunks[i] = &mChunkMemory[i * LEVEL_CHUNK_TILES];
+		mLoadedChunks.push_back(i);
+	}
+
+	resetLayers();
+}
+
+bool TileMap::load(std::string path) {
+	int file = open(path.c_str(), O_RDONLY);
+	if(file < 0) {
+		return false;
+	}
+	struct stat info;
+	if(fstat(file, &info) != 0 || info.st_size < (off_t) sizeof(MapHeader)) {
+		printf("Level %s is too short!\n", path.c_str());
+		close(file);
+		return false;
+	}
+
+	//Only read, the loader copies chunks out of it
+	size_t size = info.st_size;
+	void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if(mapping == MAP_FAILED) {
+		printf("Unable to map level %s!\n", path.c_str());
+		return false;
+	}
+
+	//Check the header before trusting any offset
+	const MapHeader *header = (const MapHeader *) mapping;
+	size_t chunkColumns = (header->columns + LEVEL_CHUNK_SIZE - 1) >> LEVEL_CHUNK_SHIFT;
+	size_t chunkRows = (header->rows + LEVEL_CHUNK_SIZE - 1) >> LEVEL_CHUNK_SHIFT;
+	const char *error = NULL;
+	if(memcmp(header->magic, MAP_MAGIC, sizeof(MAP_MAGIC)) != 0) {
+		error = "not a compiled level";
+	}
+	else if(header->version != MAP_VERSION || header->chunkSize != LEVEL_CHUNK_SIZE) {
+		error = "compiled for another version, run make maps";
+	}
+	else if(header->columns == 0 || header->rows == 0 || header->columns > MAX_LEVEL_TILES || header->rows > MAX_LEVEL_TILES || header->totalClips != TOTAL_TILE_SPRITES) {
+		error = "bad dimensions";
+	}
+	else if(header->clipOffset + (size_t) header->totalClips * sizeof(MapClip) > size || header->tileOffset + chunkColumns * chunkRows * LEVEL_CHUNK_TILES * sizeof(MapTile) > size) {
+		error = "truncated";
+	}
+	if(error != NULL) {
+		printf("Level %s: %s!\n", path.c_str(), error);
+		munmap(mapping, size);
+		return false;
+	}
+
+	clear();
+	mMapping = mapping;
+	mMappingSize = size;
+	mFileTiles = (const MapTile *) ((const char *) mapping + header->tileOffset);
+	mColumns = header->columns;
+	mRows = header->rows;
+	mChunkColumns = chunkColumns;
+	mChunkRows = chunkRows;
+
+	//Chunks stay on disk until stream() asks for them
+	int totalChunks = mChunkColumns * mChunkRows;
+	mChunks.assign(totalChunks, NULL);
+	mChunkPending.assign(totalChunks, 0);
+
+	//Memory stays the same however big the level is
+	int totalMemory = totalChunks < MAX_LOADED_CHUNKS ? totalChunks : MAX_LOADED_CHUNKS;
+	mChunkMemory.assign(totalMemory * LEVEL_CHUNK_TILES, Tile());
+	for(int i = 0; i < totalMemory; ++i) {
+		mFreeChunks.push_back(&mChunkMemory[i * LEVEL_CHUNK_TILES]);
+	}
+
+	//Clip the sprite sheet
+	const MapClip *clips = (const MapClip *) ((const char *) mapping + header->clipOffset);
+	for(int i = 0; i < TOTAL_TILE_SPRITES; ++i) {
+		gTileClips[i].x = clips[i].x;
+		gTileClips[i].y = clips[i].y;
+		gTileClips[i].w = clips[i].w;
+		gTileClips[i].h = clips[i].h;
+	}
+
+	resetLayers();
+	return true;
+}
+
+void TileMap::unmap() {
+	if(mMapping != NULL) {
+		munmap(mMapping, mMappingSize);
+		mMapping = NULL;
+		mMappingSize = 0;
+		mFileTiles = NULL;
+	}
+}
+
+void TileMap::clear() {
+	//The loader must be done with the file and the chunk memory first
+	mLoader.cancel();
+	unmap();
+
+	mColumns = 0;
+	mRows = 0;
+	mChunkColumns = 0;
+	mChunkRows = 0;
+	mChunks.clear();
+	mChunkPending.clear();
+	mLoadedChunks.clear();
+	mFreeChunks.clear();
+	mChunkMemory.clear();
+
+	freeLayers();
+	mLayerColumns = 0;
+	mLayerRows = 0;
+}
+
+void TileMap::stream(SDL_Rect &area, bool wait) {
+	//Pre-rendered pieces far away only hold video memory
+	freeLayers(area);
+
+	//Levels built in memory have nothing to stream
+	if(mFileTiles == NULL) {
+		return;
+	}
+	installLoaded();
+
+	//The chunks wanted, around the area
+	int firstColumn, firstRow, lastColumn, lastRow;
+	if(!getGridRange(area, LEVEL_CHUNK_SIZE * TILE_WIDTH, LEVEL_CHUNK_SIZE * TILE_HEIGHT, LEVEL_STREAM_MARGIN, mChunkColumns, mChunkRows, firstColumn, firstRow, lastColumn, lastRow)) {
+		firstColumn = firstRow = 0;
+		lastColumn = lastRow = -1;
+	}
+
+	//Drop the rest
+	unsigned int kept = 0;
+	for(unsigned int i = 0; i < mLoadedChunks.size(); ++i) {
+		int chunk = mLoadedChunks[i];
+		int column = chunk % mChunkColumns;
+		int row = chunk / mChunkColumns;
+		if(column >= firstColumn && column <= lastColumn && row >= firstRow && row <= lastRow) {
+			mLoadedChunks[kept++] = chunk;
+		}
+		else {
+			mFreeChunks.push_back(mChunks[chunk]);
+			mChunks[chunk] = NULL;
+		}
+	}
+	mLoadedChunks.resize(kept);
+
+	//Ask for the missing ones while there is memory for them
+	for(int row = firstRow; row <= lastRow; ++row) {
+		for(int column = firstColumn; column <= lastColumn; ++column) {
+			int chunk = row * mChunkColumns + column;
+			if(mChunks[chunk] == NULL && !mChunkPending[chunk] && !mFreeChunks.empty()) {
+				mChunkPending[chunk] = 1;
+				mLoader.request(chunk, mFileTiles + chunk * LEVEL_CHUNK_TILES, mFreeChunks.back());
+				mFreeChunks.pop_back();
+			}
+		}
+	}
+
+	if(wait) {
+		mLoader.wait();
+		installLoaded();
+	}
+}
+
+void TileMap::installLoaded() {
+	int chunk;
+	Tile *tiles;
+	while(mLoader.takeLoaded(chunk, tiles)) {
+		mChunkPending[chunk] = 0;
+		mChunks[chunk] = tiles;
+		mLoadedChunks.push_back(chunk);
+
+		//Pieces drawn while it was missing are missing its tiles
+		SDL_Rect box = {(chunk % mChunkColumns) * LEVEL_CHUNK_SIZE * TILE_WIDTH, (chunk / mChunkColumns) * LEVEL_CHUNK_SIZE * TILE_HEIGHT, LEVEL_CHUNK_SIZE * TILE_WIDTH, LEVEL_CHUNK_SIZE * TILE_HEIGHT};
+		invalidateArea(box);
+	}
+}
+
+bool TileMap::isLoaded(SDL_Rect box) {
+	int firstColumn, firstRow, lastColumn, lastRow;
+	if(!getGridRange(box, LEVEL_CHUNK_SIZE * TILE_WIDTH, LEVEL_CHUNK_SIZE * TILE_HEIGHT, 0, mChunkColumns, mChunkRows, firstColumn, firstRow, lastColumn, lastRow)) {
+		return true;
+	}
+	for(int row = firstRow; row <= lastRow; ++row) {
+		for(int column = firstColumn; column <= lastColumn; ++column) {
+			if(mChunks[row * mChunkColumns + column] == NULL) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool TileMap::getCellRange(SDL_Rect box, int &firstColumn, int &firstRow, int &lastColumn, int &lastRow) {
+	return getGridRange(box, TILE_WIDTH, TILE_HEIGHT, 0, mColumns, mRows, firstColumn, firstRow, lastColumn, lastRow);
+}
+
+SDL_Rect TileMap::getBox(int index) {
+	SDL_Rect box = {(index % mColumns) * TILE_WIDTH, (index / mColumns) * TILE_HEIGHT, TILE_WIDTH, TILE_HEIGHT};
+	return box;
+}
+
+SDL_Rect TileMap::getCollisionBox(int index) {
+	SDL_Rect box = getBox(index);
+
+	//Only the upper half is solid
+	if(getTile(index).isTopHalf()) {
+		box.h = TILE_HEIGHT / 2;
+	}
+	return box;
+}
+
+bool TileMap::touchesSlope(int index, SDL_Rect box, SDL_Rect &contact) {
+	//Move the box into tile space
+	SDL_Rect tileBox = getBox(index);
+	box.x -= tileBox.x;
+	box.y -= tileBox.y;
+	if(!getSlopeContact(getTile(index).getSlope(), box, contact)) {
+		return false;
+	}
+
+	//And the contact back out
+	contact.x += tileBox.x;
+	contact.y += tileBox.y;
+	return true;
+}
+
+void TileMap::render(SDL_Rect &camera) {
+	if(mLayersFailed) {
+		renderTiles(camera);
+		return;
+	}
+
+	//Pieces under the camera
+	int firstColumn, firstRow, lastColumn, lastRow;
+	if(!getGridRange(camera, TILE_LAYER_WIDTH, TILE_LAYER_HEIGHT, 0, mLayerColumns, mLayerRows, firstColumn, firstRow, lastColumn, lastRow)) {
+		return;
+	}
+
+	SDL_Rect box = {0, 0, TILE_LAYER_WIDTH, TILE_LAYER_HEIGHT};
+	for(int row = firstRow; row <= lastRow; ++row) {
+		box.y = row * TILE_LAYER_HEIGHT - camera.y;
+		for(int column = firstColumn; column <= lastColumn; ++column) {
+			int index = row * mLayerColumns + column;
+			std::unordered_map<int, Layer>::iterator found = mLayers.find(index);
+			if(found == mLayers.end()) {
+				Layer layer = {NULL, true};
+				found = mLayers.insert(std::make_pair(index, layer)).first;
+			}
+			if(found->second.dirty && !buildLayer(index, found->second)) {
+				//Draw the tiles directly from now on
+				LOG_WARNING("tile layer textures unsupported, drawing tiles directly...");
+				mLayersFailed = true;
+				freeLayers();
+				renderTiles(camera);
+				return;
+			}
+
+			box.x = column * TILE_LAYER_WIDTH - camera.x;
+			SDL_RenderCopy(gRenderer, found->second.texture, NULL, &box);
+		}
+	}
+}
+
+void TileMap::renderTiles(SDL_Rect &camera) {
+	//Only the cells under the camera, so the cost follows the screen size
+	int firstColumn, firstRow, lastColumn, lastRow;
+	if(!getCellRange(camera, firstColumn, firstRow, lastColumn, lastRow)) {
+		return;
+	}
+
+	SDL_Rect box = {0, 0, TILE_WIDTH, TILE_HEIGHT};
+	for(int row = firstRow; row <= lastRow; ++row) {
+		box.y = row * TILE_HEIGHT;
+		for(int column = firstColumn; column <= lastColumn; ++column) {
+			Tile *tile = findTile(column, row);
+			if(tile != NULL) {
+				box.x = column * TILE_WIDTH;
+				tile->render(box, camera);
+			}
+		}
+	}
+}
+
+void TileMap::resetLayers() {
+	//Enough pieces to cover the level, drawn the first time they are seen
+	freeLayers();
+	mLayerColumns = (mColumns * TILE_WIDTH + TILE_LAYER_WIDTH - 1) / TILE_LAYER_WIDTH;
+	mLayerRows = (mRows * TILE_HEIGHT + TILE_LAYER_HEIGHT - 1) / TILE_LAYER_HEIGHT;
+}
+
+bool TileMap::buildLayer(int index, Layer &layer) {
+	if(layer.texture == NULL) {
+		layer.texture = SDL_CreateTexture(gRenderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, TILE_LAYER_WIDTH, TILE_LAYER_HEIGHT);
+		if(layer.texture == NULL) {
+			return false;
+		}
+		SDL_SetTextureBlendMode(layer.texture, SDL_BLENDMODE_BLEND);
+	}
+	if(SDL_SetRenderTarget(gRenderer, layer.texture) != 0) {
+		return false;
+	}
+
+	//Start from a transparent piece
+	Uint8 red, green, blue, alpha;
+	SDL_GetRenderDrawColor(gRenderer, &red, &green, &blue, &alpha);
+	SDL_SetRenderDrawColor(gRenderer, 0, 0, 0, 0);
+	SDL_RenderClear(gRenderer);
+
+	//Tiles do not overlap, so copy their pixels as they are
+	SDL_Rect box = {(index % mLayerColumns) * TILE_LAYER_WIDTH, (index / mLayerColumns) * TILE_LAYER_HEIGHT, TILE_LAYER_WIDTH, TILE_LAYER_HEIGHT};
+	gTileTexture.setBlendMode(SDL_BLENDMODE_NONE);
+	renderTiles(box);
+	gTileTexture.setBlendMode(SDL_BLENDMODE_BLEND);
+
+	SDL_SetRenderDrawColor(gRenderer, red, green, blue, alpha);
+	SDL_SetRenderTarget(gRenderer, NULL);
+	layer.dirty = false;
+	return true;
+}
+
+void TileMap::invalidate(int index) {
+	invalidateArea(getBox(index));
+}
+
+void TileMap::invalidateArea(SDL_Rect box) {
+	//A tile can straddle piece edges
+	int firstColumn, firstRow, lastColumn, lastRow;
+	if(!getGridRange(box, TILE_LAYER_WIDTH, TILE_LAYER_HEIGHT, 0, mLayerColumns, mLayerRows, firstColumn, firstRow, lastColumn, lastRow)) {
+		return;
+	}
+	for(int row = firstRow; row <= lastRow; ++row) {
+		for(int column = firstColumn; column <= lastColumn; ++column) {
+			std::unordered_map<int, Layer>::iterator found = mLayers.find(row * mLayerColumns + column);
+			if(found != mLayers.end()) {
+				found->second.dirty = true;
+			}
+		}
+	}
+}
+
+void TileMap::invalidate() {
+	for(std::unordered_map<int, Layer>::iterator i = mLayers.begin(); i != mLayers.end(); ++i) {
+		i->second.dirty = true;
+	}
+}
+
+void TileMap::freeLayers() {
+	for(std::unordered_map<int, Layer>::iterator i = mLayers.begin(); i != mLayers.end(); ++i) {
+		if(i->second.texture != NULL) {
+			SDL_DestroyTexture(i->second.texture);
+		}
+	}
+	mLayers.clear();
+}
+
+void TileMap::freeLayers(SDL_Rect area) {
+	//Keep a piece of margin so walking along an edge does not redraw
+	int firstColumn, firstRow, lastColumn, lastRow;
+	if(!getGridRange(area, TILE_LAYER_WIDTH, TILE_LAYER_HEIGHT, 1, mLayerColumns, mLayerRows, firstColumn, firstRow, lastColumn, lastRow)) {
+		freeLayers();
+		return;
+	}
+
+	std::unordered_map<int, Layer>::iterator i = mLayers.begin();
+	while(i != mLayers.end()) {
+		int column = i->first % mLayerColumns;
+		int row = i->first / mLayerColumns;
+		if(column >= firstColumn && column <= lastColumn && row >= firstRow && row <= lastRow) {
+			++i;
+		}
+		else {
+			if(i->second.texture != NULL) {
+				SDL_DestroyTexture(i->second.texture);
+			}
+			i = mLayers.erase(i);
+		}
+	}
+}
+
+int TileMap::getColumns() {
+	return mColumns;
+}
+
+int TileMap::getRows() {
+	return mRows;
+}
+
+int TileMap::getTotalTiles() {
+	return mColumns * mRows;
+}
+
+int TileMap::getWidth() {
+	return mColumns * TILE_WIDTH;
+}
+
+int TileMap::getHeight() {
+	return mRows * TILE_HEIGHT;
+}
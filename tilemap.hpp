@@ -0,0 +1,170 @@
+#ifndef TILEMAP_HPP
+	#define TILEMAP_HPP
+#include <SDL.h>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include "globals.hpp"
+#include "tiles.hpp"
+#include "chunkloader.hpp"
+
+//The level, sized by its map and stored in square chunks of packed tiles
+//Levels from a level file keep only the chunks around the camera in memory
+class TileMap {
+	public:
+		//Initializes an empty level
+		TileMap();
+
+		//Unmaps the level file
+		~TileMap();
+
+		//Sizes the level and fills it with empty tiles, every chunk stays in memory
+		void reset(int columns, int rows);
+
+		//Maps a compiled level file, its chunks are loaded by stream(), also sets the tile clips
+		bool load(std::string path);
+
+		//Empties the level
+		void clear();
+
+		//Loads the chunks around an area and drops the rest, optionally waiting for them
+		//Call between steps, the chunks only change here
+		void stream(SDL_Rect &area, bool wait = false);
+
+		//Every chunk under a box is in memory
+		bool isLoaded(SDL_Rect box);
+
+		//Sets the type of a tile, ignored while its chunk is not loaded
+		inline void setTile(int index, int tileType) {
+			Tile *tile = findTile(index % mColumns, index / mColumns);
+			if(tile != NULL) {
+				*tile = Tile(tileType);
+				invalidate(index);
+			}
+		}
+
+		//Tiles in chunks that are not loaded are empty
+		inline Tile getTile(int index) {
+			return getTile(index % mColumns, index / mColumns);
+		}
+
+		inline Tile getTile(int column, int row) {
+			Tile *tile = findTile(column, row);
+			return tile != NULL ? *tile : Tile();
+		}
+
+		//Gets the cells overlapped by a box, returns false if it misses the level
+		bool getCellRange(SDL_Rect box, int &firstColumn, int &firstRow, int &lastColumn, int &lastRow);
+
+		//Get the boxes of a tile
+		SDL_Rect getBox(int index);
+		SDL_Rect getCollisionBox(int index);
+
+		//Finds where a box meets the surface of a sloped tile
+		bool touchesSlope(int index, SDL_Rect box, SDL_Rect &contact);
+
+		inline bool isTopHalf(int index) {
+			return getTile(index).isTopHalf();
+		}
+
+		inline bool isDiagonal(int index) {
+			return getTile(index).isDiagonal();
+		}
+
+		//Shows the level from the pre-rendered layer pieces under the camera
+		void render(SDL_Rect &camera);
+
+		//Marks the layer pieces holding a tile for redrawing
+		void invalidate(int index);
+
+		//Marks every layer piece for redrawing, for when the renderer loses its targets
+		void invalidate();
+
+		//Level dimensions in tiles
+		int getColumns();
+		int getRows();
+		int getTotalTiles();
+
+		//Level dimensions in pixels
+		int getWidth();
+		int getHeight();
+
+	private:
+		//Level dimensions in tiles
+		int mColumns;
+		int mRows;
+
+		//Level dimensions in chunks
+		int mChunkColumns;
+		int mChunkRows;
+
+		//Tiles of each chunk, NULL while the chunk is on disk
+		std::vector<Tile *> mChunks;
+
+		//Chunks asked of the loader
+		std::vector<Uint8> mChunkPending;
+
+		//Chunks in memory, for dropping them
+		std::vector<int> mLoadedChunks;
+
+		//Memory of every chunk that can be loaded at once, and the pieces of it not in use
+		std::vector<Tile> mChunkMemory;
+		std::vector<Tile *> mFreeChunks;
+
+		//Chunk records of the mapped level file, NULL for levels built in memory
+		const MapTile *mFileTiles;
+		void *mMapping;
+		size_t mMappingSize;
+
+		ChunkLoader mLoader;
+
+		//Finds a tile in its chunk, NULL if the chunk is not loaded
+		inline Tile *findTile(int column, int row) {
+			Tile *chunk = mChunks[(row >> LEVEL_CHUNK_SHIFT) * mChunkColumns + (column >> LEVEL_CHUNK_SHIFT)];
+			if(chunk == NULL) {
+				return NULL;
+			}
+			return &chunk[((row & (LEVEL_CHUNK_SIZE - 1)) << LEVEL_CHUNK_SHIFT) + (column & (LEVEL_CHUNK_SIZE - 1))];
+		}
+
+		//Unmaps the level file
+		void unmap();
+
+		//Puts the chunks the loader copied into the level
+		void installLoaded();
+
+		//Sizes the layer pieces to the level
+		void resetLayers();
+
+		//Marks the layer pieces over a box for redrawing
+		void invalidateArea(SDL_Rect box);
+
+		//Draws the tiles under the camera one by one
+		void renderTiles(SDL_Rect &camera);
+
+		//A pre-rendered piece of the tile layer
+		struct Layer {
+			SDL_Texture *texture;
+
+			//Tiles under it changed since it was drawn
+			bool dirty;
+		};
+
+		//Redraws a layer piece, returns false if the renderer cannot draw to textures
+		bool buildLayer(int index, Layer &layer);
+
+		//Deallocates the layer pieces, or only those away from an area
+		void freeLayers();
+		void freeLayers(SDL_Rect area);
+
+		//Level dimensions in layer pieces
+		int mLayerColumns;
+		int mLayerRows;
+
+		//Pieces drawn so far by index, only those near the camera are kept
+		std::unordered_map<int, Layer> mLayers;
+
+		//Set when the renderer cannot draw to textures
+		bool mLayersFailed;
+};
+#endif
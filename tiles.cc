@@ -1,60 +1,128 @@
 #include "tiles.hpp"
 #include "globals.hpp"
 #include "iostream"
+#include <algorithm>
+#include <cmath>
 
-Tile::Tile(int x, int y, int tileType) {
-	//Get the offsets
-	mBox.x = x;
-	mBox.y = y;
+//Rising right at 45 degrees is the diagonal tile, the rest are spares for new sprites
+const SlopeShape gSlopeShapes[] = {
+	{TILE_HEIGHT - 1, 0},
+	{0, TILE_HEIGHT - 1},
+	{TILE_HEIGHT - 1, TILE_HEIGHT / 2},
+	{TILE_HEIGHT / 2 - 1, 0},
+	{TILE_HEIGHT / 2, TILE_HEIGHT - 1},
+	{0, TILE_HEIGHT / 2 - 1}
+};
+const int TOTAL_SLOPE_SHAPES = sizeof(gSlopeShapes) / sizeof(gSlopeShapes[0]);
 
-	//Set the collision box
-	mBox.w = TILE_WIDTH;
-	mBox.h = TILE_HEIGHT;
+const Sint8 gTileTypeSlopes[TOTAL_TILE_SPRITES] = {
+	-1, -1, -1, -1,
+	-1, -1, -1, -1,
+	-1, -1, -1, -1,
+	-1, -1, -1, -1,
+	-1, -1, -1, -1,
+	-1, -1, -1, -1,
+	-1, -1, -1, -1,
+	-1, -1, -1, -1,
+	-1, -1, -1, -1,
+	-1, -1, -1, -1,
+	-1, -1, -1, -1,
+	-1, -1, -1, -1,
+	0, -1, -1, -1,
+	-1, -1, -1, -1,
+	-1, -1, -1, -1,
+	-1, -1, -1, -1,
+	-1, -1, -1, -1,
+	-1, -1, -1, -1,
+	-1, -1, -1, -1,
+	-1, -1, -1, -1,
+	-1, -1, -1, -1,
+	-1, -1, -1, -1,
+	-1, -1, -1, -1,
+	-1, -1, -1, -1,
+};
 
-	//Get the tile type
-	if(tileType % 4 != 0 && tileType > 20 && tileType <= 27 && tileType != 23) {
-		topHalf = true;
-		mCollisionBox = mBox;
-		mCollisionBox.h = (TILE_HEIGHT / 2);
-	}
-	if(tileType == 48) {
-		diagonalTile = true;
-		int tmp = 0;
-		mPixelBox.resize(80);
-		/*
-		mPixelBox[tmp] = mBox;
-		mPixelBox[tmp].y = mBox.y + 40;
-		*/
-		for(int i = 79; i >= 0; --i) {
-			mPixelBox[tmp].x = mBox.x + i;
-			mPixelBox[tmp].y = mBox.y + (79 - i);
-			mPixelBox[tmp].w = 1;
-			mPixelBox[tmp++].h = 1;
+//Surface lookups sampled from the slope lines
+struct SlopeSurface {
+	//The surface is highest at the right edge
+	bool risingRight;
+
+	//Surface row of each column
+	int rows[TILE_WIDTH];
+
+	//First and last column on each row, -1 if the surface never reaches it
+	int firstColumns[TILE_HEIGHT];
+	int lastColumns[TILE_HEIGHT];
+};
+
+static SlopeSurface gSlopeSurfaces[sizeof(gSlopeShapes) / sizeof(gSlopeShapes[0])];
+
+//Samples every slope line once before the game starts
+static bool buildSlopeSurfaces() {
+	for(int slope = 0; slope < TOTAL_SLOPE_SHAPES; ++slope) {
+		SlopeSurface &surface = gSlopeSurfaces[slope];
+		const SlopeShape &shape = gSlopeShapes[slope];
+		surface.risingRight = shape.leftY >= shape.rightY;
+		for(int y = 0; y < TILE_HEIGHT; ++y) {
+			surface.firstColumns[y] = -1;
+			surface.lastColumns[y] = -1;
+		}
+		for(int x = 0; x < TILE_WIDTH; ++x) {
+			int y = (int) floor(shape.leftY + (shape.rightY - shape.leftY) * x / (double) (TILE_WIDTH - 1) + 0.5);
+			surface.rows[x] = y;
+			if(surface.firstColumns[y] == -1) surface.firstColumns[y] = x;
+			surface.lastColumns[y] = x;
 		}
 	}
-	mType = tileType;
+	return true;
 }
 
-void Tile::render(SDL_Rect& camera) {
-	//If the tile is on screen
-	if(checkCollision(camera, mBox)) {
-		//Show the tile
-		gTileTexture.render(mBox.x - camera.x, mBox.y - camera.y, &gTileClips[mType]);
+static bool gSlopeSurfacesBuilt = buildSlopeSurfaces();
+
+bool getSlopeContact(int slope, SDL_Rect box, SDL_Rect &contact) {
+	const SlopeSurface &surface = gSlopeSurfaces[slope];
+
+	//Columns of the tile under the box
+	int first = box.x < 0 ? 0 : box.x;
+	int last = box.x + box.w - 1;
+	if(last > TILE_WIDTH - 1) last = TILE_WIDTH - 1;
+	if(first > last) {
+		return false;
 	}
-}
 
-int Tile::getType() {
-	return mType;
-}
+	//The surface moves at most a row per column, so it covers every row between its ends
+	int top = std::min(surface.rows[first], surface.rows[last]);
+	int bottom = std::max(surface.rows[first], surface.rows[last]);
 
-SDL_Rect Tile::getBox() {
-	return mBox;
+	//Highest surface row inside the box
+	int y = top > box.y ? top : box.y;
+	if(y > bottom || y > box.y + box.h - 1) {
+		return false;
+	}
+
+	//Column where the surface crosses that row, on the high side of the slope
+	int x;
+	if(surface.risingRight) {
+		x = std::min(surface.lastColumns[y], last);
+	}
+	else {
+		x = std::max(surface.firstColumns[y], first);
+	}
+
+	contact.x = x;
+	contact.y = y;
+	contact.w = 1;
+	contact.h = 1;
+	return true;
 }
 
-SDL_Rect Tile::getCollisionBox() {
-	return mCollisionBox;
+Tile::Tile(int tileType) {
+	//Get the tile type
+	mType = tileType;
+	mFlags = gTileTypeFlags[tileType];
 }
 
-std::vector<SDL_Rect> &Tile::getPixelBox() {
-	return mPixelBox;
+void Tile::render(SDL_Rect &box, SDL_Rect &camera) {
+	//Show the tile, the map only hands over tiles on screen
+	gTileTexture.render(box.x - camera.x, box.y - camera.y, &gTileClips[mType]);
 }
@@ -1,37 +1,72 @@
 #ifndef TILES_HPP
 	#define TILES_HPP
 #include <SDL.h>
-#include <vector>
-//The tile
+#include "tiletypes.hpp"
+
+//Surface of a sloped tile, the line between its rows at the left and right edges
+struct SlopeShape {
+	int leftY;
+	int rightY;
+};
+
+//Slope shapes, steepest is one row per column
+extern const SlopeShape gSlopeShapes[];
+extern const int TOTAL_SLOPE_SHAPES;
+
+//Slope shape of every tile type, -1 if the tile is not sloped
+extern const Sint8 gTileTypeSlopes[];
+
+//Finds the highest surface pixel of a slope inside a box, both in tile space
+bool getSlopeContact(int slope, SDL_Rect box, SDL_Rect &contact);
+
+//The tile, packed so a whole level streams through cache
 class Tile {
 	public:
-		//Initializes position and type
-		Tile(int x, int y, int tileType);
+		//Initializes type and collision flags
+		Tile(int tileType = 0);
 
 		//Shows the tile
-		void render(SDL_Rect& camera);
+		void render(SDL_Rect &box, SDL_Rect &camera);
 
 		//Get the tile type
-		int getType();
-		bool diagonalTile = false;
-		bool topHalf = false;
-		int pixelTouched = 0;
+		inline int getType() {
+			return mType;
+		}
 
-		//Get the collision box
-		SDL_Rect getBox();
-		SDL_Rect getCollisionBox();
-		std::vector<SDL_Rect> &getPixelBox();
+		inline Uint8 getFlags() {
+			return mFlags;
+		}
 
-	private:
-		//The attributes of the tile
-		SDL_Rect mBox;
+		//Blocks movement
+		inline bool isWall() {
+			return (mFlags & TILE_WALL) != 0;
+		}
+
+		//Only the upper half of the tile is solid
+		inline bool isTopHalf() {
+			return (mFlags & TILE_TOP_HALF) != 0;
+		}
+
+		//Solid along the diagonal only
+		inline bool isDiagonal() {
+			return (mFlags & TILE_DIAGONAL) != 0;
+		}
 
-		SDL_Rect mCollisionBox;
+		//Can be tapped from above
+		inline bool isTap() {
+			return (mFlags & TILE_TAP) != 0;
+		}
 
-		// Per-pixel collision box;
-		std::vector<SDL_Rect> mPixelBox;
+		//Get the slope shape
+		inline int getSlope() {
+			return gTileTypeSlopes[mType];
+		}
 
+	private:
 		//The tile type
-		int mType;
+		Uint8 mType;
+
+		//Collision flags looked up from the type
+		Uint8 mFlags;
 };
 #endif
@@ -0,0 +1,41 @@
+#include "tiletypes.hpp"
+#include "globals.hpp"
+
+//One row per row of four sprites in tiles.png
+const Uint8 gTileTypeFlags[TOTAL_TILE_SPRITES] = {
+	0, TILE_WALL | TILE_TAP, TILE_WALL | TILE_TAP, TILE_WALL | TILE_TAP,
+	0, TILE_WALL | TILE_TAP, TILE_WALL | TILE_TAP, TILE_WALL | TILE_TAP,
+	0, TILE_WALL | TILE_TAP, TILE_WALL | TILE_TAP, TILE_WALL | TILE_TAP,
+	0, TILE_WALL | TILE_TAP, TILE_WALL | TILE_TAP, TILE_WALL | TILE_TAP,
+	0, TILE_WALL | TILE_TAP, TILE_WALL | TILE_TAP, TILE_WALL | TILE_TAP,
+	0, TILE_WALL | TILE_TOP_HALF, TILE_WALL | TILE_TOP_HALF, 0,
+	0, TILE_WALL | TILE_TOP_HALF, TILE_WALL | TILE_TOP_HALF, TILE_WALL | TILE_TOP_HALF,
+	0, 0, 0, 0,
+	0, 0, 0, 0,
+	0, 0, 0, 0,
+	0, 0, 0, 0,
+	0, 0, 0, 0,
+	TILE_WALL | TILE_DIAGONAL, TILE_WALL, TILE_WALL, TILE_WALL,
+	0, TILE_WALL, TILE_WALL, TILE_WALL,
+	0, TILE_WALL, TILE_WALL, TILE_WALL,
+	0, TILE_WALL, TILE_WALL, TILE_WALL,
+	0, TILE_WALL, TILE_WALL, TILE_WALL,
+	0, 0, 0, 0,
+	0, 0, 0, 0,
+	0, 0, 0, 0,
+	0, 0, 0, 0,
+	0, 0, 0, 0,
+	0, 0, 0, 0,
+	0, 0, 0, 0,
+};
+
+void getTileClip(int tileType, SDL_Rect &clip) {
+	//Each half of the sheet is its own column of sprites, filled row by row
+	int half = TOTAL_TILE_SPRITES / 2;
+	int perRow = (TILESHEET_WIDTH / 2) / TILE_WIDTH;
+	int index = tileType % half;
+	clip.x = (tileType >= half ? TILESHEET_WIDTH / 2 : 0) + (index % perRow) * TILE_WIDTH;
+	clip.y = (index / perRow) * TILE_HEIGHT;
+	clip.w = TILE_WIDTH;
+	clip.h = TILE_HEIGHT;
+}
@@ -0,0 +1,18 @@
+#ifndef TILETYPES_HPP
+	#define TILETYPES_HPP
+#include <SDL.h>
+
+//Collision properties of a tile type
+enum TileFlags {
+	TILE_WALL = 1 << 0,
+	TILE_TOP_HALF = 1 << 1,
+	TILE_DIAGONAL = 1 << 2,
+	TILE_TAP = 1 << 3
+};
+
+//Collision flags for every tile type in the sprite sheet
+extern const Uint8 gTileTypeFlags[];
+
+//Gets where a tile type sits in the sprite sheet
+void getTileClip(int tileType, SDL_Rect &clip);
+#endif
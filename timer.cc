@@ -1,8 +1,10 @@
 #include "timer.hpp"
+#include "gameclock.hpp"
+
 LTimer::LTimer() {
 	//Initialize the variables
-	mStartTicks = 0;
-	mPausedTicks = 0;
+	mStartTime = 0;
+	mPausedTime = 0;
 
 	mPaused = false;
 	mStarted = false;
@@ -16,8 +18,8 @@ void LTimer::start() {
 	mPaused = false;
 
 	//Get the current clock time
-	mStartTicks = SDL_GetTicks();
-	mPausedTicks = 0;
+	mStartTime = gClock.getTime();
+	mPausedTime = 0;
 }
 
 void LTimer::stop() {
@@ -27,9 +29,9 @@ void LTimer::stop() {
 	//Unpause the timer
 	mPaused = false;
 
-	//Clear tick variables
-	mStartTicks = 0;
-	mPausedTicks = 0;
+	//Clear time variables
+	mStartTime = 0;
+	mPausedTime = 0;
 }
 
 void LTimer::pause() {
@@ -39,9 +41,9 @@ void LTimer::pause() {
 		//Pause the timer
 		mPaused = true;
 
-		//Calculate the paused ticks
-		mPausedTicks = SDL_GetTicks() - mStartTicks;
-		mStartTicks = 0;
+		//Calculate the paused time
+		mPausedTime = gClock.getTime() - mStartTime;
+		mStartTime = 0;
 	}
 }
 
@@ -52,17 +54,21 @@ void LTimer::unpause() {
 		//Unpause the timer
 		mPaused = false;
 
-		//Reset the starting ticks
-		mStartTicks = SDL_GetTicks() - mPausedTicks;
+		//Reset the starting time
+		mStartTime = gClock.getTime() - mPausedTime;
 
-		//Reset the paused ticks
-		mPausedTicks = 0;
+		//Reset the paused time
+		mPausedTime = 0;
 	}
 }
 
 Uint32 LTimer::getTicks() {
+	return (Uint32) (getSeconds() * 1000);
+}
+
+double LTimer::getSeconds() {
 	//The actual timer time
-	Uint32 time = 0;
+	double time = 0;
 
 	//If the timer is running
 	if(mStarted)
@@ -70,13 +76,13 @@ Uint32 LTimer::getTicks() {
 		//If the timer is paused
 		if(mPaused)
 		{
-			//Return the number of ticks when the timer was paused
-			time = mPausedTicks;
+			//Return the time when the timer was paused
+			time = mPausedTime;
 		}
 		else
 		{
 			//Return the current time minus the start time
-			time = SDL_GetTicks() - mStartTicks;
+			time = gClock.getTime() - mStartTime;
 		}
 	}
 
@@ -1,6 +1,8 @@
 #ifndef TIMER_HPP
 	#define TIMER_HPP
 #include <SDL.h>
+
+//Times on the game clock, so timers stop while the game is paused and read the time of the current frame
 class LTimer {
 	public:
 		//Initializes variables
@@ -12,8 +14,9 @@ class LTimer {
 		void pause();
 		void unpause();
 
-		//Gets the timer's time
+		//Gets the timer's time in milliseconds and in seconds
 		Uint32 getTicks();
+		double getSeconds();
 
 		//Checks the status of the timer
 		bool isStarted();
@@ -21,10 +24,10 @@ class LTimer {
 
 	private:
 		//The clock time when the timer started
-		Uint32 mStartTicks;
+		double mStartTime;
 
-		//The ticks stored when the timer was paused
-		Uint32 mPausedTicks;
+		//The time stored when the timer was paused
+		double mPausedTime;
 
 		//The timer status
 		bool mPaused;
@@ -0,0 +1,97 @@
+//Compiles text maps into the level files the game maps into memory
+//Usage: mapc <input.map> <output.lvl> [columns rows]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include <vector>
+#include "../globals.hpp"
+#include "../tiletypes.hpp"
+#include "../mapformat.hpp"
+
+int main(int argc, char *args[]) {
+	if(argc != 3 && argc != 5) {
+		fprintf(stderr, "usage: %s <input.map> <output.lvl> [columns rows]\n", args[0]);
+		return 1;
+	}
+
+	//Text maps do not say how big they are
+	int columns = DEFAULT_LEVEL_COLUMNS;
+	int rows = DEFAULT_LEVEL_ROWS;
+	if(argc == 5) {
+		columns = atoi(args[3]);
+		rows = atoi(args[4]);
+		if(columns <= 0 || rows <= 0 || columns > MAX_LEVEL_TILES || rows > MAX_LEVEL_TILES) {
+			fprintf(stderr, "%s: bad level size %s x %s\n", args[0], args[3], args[4]);
+			return 1;
+		}
+	}
+
+	std::ifstream map(args[1]);
+	if(!map) {
+		fprintf(stderr, "%s: unable to open %s\n", args[0], args[1]);
+		return 1;
+	}
+
+	//Chunks past the edge of the level are padded with empty tiles
+	int chunkColumns = (columns + LEVEL_CHUNK_SIZE - 1) / LEVEL_CHUNK_SIZE;
+	int chunkRows = (rows + LEVEL_CHUNK_SIZE - 1) / LEVEL_CHUNK_SIZE;
+	MapTile empty = {0, 0};
+	std::vector<MapTile> tiles((size_t) chunkColumns * chunkRows * LEVEL_CHUNK_TILES, empty);
+
+	//Read every tile into its chunk, with its collision flags looked up once here
+	for(unsigned int i = 0; i < (unsigned int) (columns * rows); ++i) {
+		int tileType = -1;
+		map >> tileType;
+		if(map.fail()) {
+			fprintf(stderr, "%s: unexpected end of file after %u tiles\n", args[1], i);
+			return 1;
+		}
+		if(tileType < 0 || tileType >= TOTAL_TILE_SPRITES) {
+			fprintf(stderr, "%s: invalid tile type %d at %u\n", args[1], tileType, i);
+			return 1;
+		}
+		int column = i % columns;
+		int row = i / columns;
+		int chunk = (row / LEVEL_CHUNK_SIZE) * chunkColumns + column / LEVEL_CHUNK_SIZE;
+		MapTile &tile = tiles[(size_t) chunk * LEVEL_CHUNK_TILES + (row % LEVEL_CHUNK_SIZE) * LEVEL_CHUNK_SIZE + column % LEVEL_CHUNK_SIZE];
+		tile.type = tileType;
+		tile.flags = gTileTypeFlags[tileType];
+	}
+
+	MapClip clips[TOTAL_TILE_SPRITES];
+	for(int i = 0; i < TOTAL_TILE_SPRITES; ++i) {
+		SDL_Rect clip;
+		getTileClip(i, clip);
+		clips[i].x = clip.x;
+		clips[i].y = clip.y;
+		clips[i].w = clip.w;
+		clips[i].h = clip.h;
+	}
+
+	MapHeader header;
+	memcpy(header.magic, MAP_MAGIC, sizeof(MAP_MAGIC));
+	header.version = MAP_VERSION;
+	header.columns = columns;
+	header.rows = rows;
+	header.chunkSize = LEVEL_CHUNK_SIZE;
+	header.totalClips = TOTAL_TILE_SPRITES;
+	header.clipOffset = sizeof(header);
+	header.tileOffset = header.clipOffset + sizeof(clips);
+
+	FILE *level = fopen(args[2], "wb");
+	if(level == NULL) {
+		fprintf(stderr, "%s: unable to create %s\n", args[0], args[2]);
+		return 1;
+	}
+	bool written = fwrite(&header, sizeof(header), 1, level) == 1;
+	written = written && fwrite(clips, sizeof(clips), 1, level) == 1;
+	written = written && fwrite(tiles.data(), sizeof(MapTile), tiles.size(), level) == tiles.size();
+	if(fclose(level) != 0 || !written) {
+		fprintf(stderr, "%s: unable to write %s\n", args[0], args[2]);
+		return 1;
+	}
+
+	printf("%s: %d x %d tiles\n", args[2], columns, rows);
+	return 0;
+}
@@ -0,0 +1,363 @@
+#include <stdio.h>
+#include <string>
+#include <fstream>
+#include "world.hpp"
+#include "logger.hpp"
+#include "profiler.hpp"
+#include "tiles.hpp"
+#include "globals.hpp"
+
+bool checkCollision(SDL_Rect a, SDL_Rect b) {
+	//The sides of the rectangles
+	int leftA, leftB;
+	int rightA, rightB;
+	int topA, topB;
+	int bottomA, bottomB;
+
+	//Calculate the sides of rect A
+	leftA = a.x;
+	rightA = a.x + a.w;
+	topA = a.y;
+	bottomA = a.y + a.h;
+
+	//Calculate the sides of rect B
+	leftB = b.x;
+	rightB = b.x + b.w;
+	topB = b.y;
+	bottomB = b.y + b.h;
+
+	//If none of the sides from A are outside B, tested without branching
+	return (bottomA > topB) & (topA < bottomB) & (rightA > leftB) & (leftA < rightB);
+}
+
+bool checkUpperCollision(SDL_Rect a, SDL_Rect b) {
+	//The sides of the rectangles
+	int leftA, leftB;
+	int rightA, rightB;
+	int topA, topB;
+	int bottomA, bottomB;
+
+	//Calculate the sides of rect A
+	leftA = a.x;
+	rightA = a.x + a.w;
+	topA = a.y;
+	bottomA = a.y + a.h;
+
+	//Calculate the sides of rect B
+	leftB = b.x;
+	rightB = b.x + b.w;
+	topB = b.y - 50;
+	bottomB = b.y + b.h;
+
+	//If none of the sides from A are outside B, tested without branching
+	return (bottomA > topB) & (topA < bottomB) & (rightA > leftB) & (leftA < rightB);
+}
+
+bool setTiles(TileMap &tiles, std::string mapName) {
+	//Use the compiled level when there is one
+	std::string levelName = mapName.substr(0, mapName.rfind('.')) + ".lvl";
+	if(tiles.load(levelName)) {
+		//Have the start of the level in memory before the first step
+		SDL_Rect start = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
+		tiles.stream(start, true);
+		return true;
+	}
+	LOG_WARNING("no compiled level " + levelName + ", parsing " + mapName + "...");
+
+	//Success flag
+	bool tilesLoaded = true;
+
+	//Open the map
+	std::ifstream map(mapName);
+
+	//If the map couldn't be loaded
+	if(!map) {
+		printf("Unable to load map file!\n");
+		tilesLoaded = false;
+	}
+	else {
+		//Initialize the tiles
+		tiles.reset(DEFAULT_LEVEL_COLUMNS, DEFAULT_LEVEL_ROWS);
+		for(int i = 0; i < tiles.getTotalTiles(); ++i) {
+			//Determines what kind of tile will be made
+			int tileType = -1;
+
+			//Read tile from map file
+			map >> tileType;
+
+			//If the was a problem in reading the map
+			if(map.fail()) {
+				//Stop loading map
+				printf("Error loading map: Unexpected end of file!\n");
+				tilesLoaded = false;
+				break;
+			}
+
+			//If the number is a valid tile number
+			if((tileType >= 0) && (tileType < TOTAL_TILE_SPRITES)) {
+				tiles.setTile(i, tileType);
+			}
+			//If we don't recognize the tile type
+			else {
+				//Stop loading map
+				printf("Error loading map: Invalid tile type at %d!\n", i);
+				tilesLoaded = false;
+				break;
+			}
+		}
+
+		//Clip the sprite sheet
+		if(tilesLoaded) {
+			for(int i = 0; i < TOTAL_TILE_SPRITES; ++i) {
+				getTileClip(i, gTileClips[i]);
+			}
+		}
+	}
+
+	//Close the file
+	map.close();
+
+	//If the map was loaded fine
+	return tilesLoaded;
+}
+
+bool touchesTap(SDL_Rect box, TileMap &tiles) {
+	//Tap boxes reach 50 pixels above their tile, so look one stretch lower
+	SDL_Rect reach = box;
+	reach.h += 50;
+
+	int firstColumn, firstRow, lastColumn, lastRow;
+	if(!tiles.getCellRange(reach, firstColumn, firstRow, lastColumn, lastRow)) {
+		return false;
+	}
+
+	//Go through the tiles near the box
+	for(int row = firstRow; row <= lastRow; ++row) {
+		for(int column = firstColumn; column <= lastColumn; ++column) {
+			//If the tile is a wall type tile
+			if(tiles.getTile(column, row).isTap()) {
+				//If the collision box touches the wall tile
+				if(checkUpperCollision(box, tiles.getBox(row * tiles.getColumns() + column))) {
+					return true;
+				}
+			}
+		}
+	}
+
+	//If no wall tiles were touched
+	return false;
+}
+
+int touchesWall(SDL_Rect box, TileMap &tiles, SDL_Rect &contact) {
+	int firstColumn, firstRow, lastColumn, lastRow;
+	if(!tiles.getCellRange(box, firstColumn, firstRow, lastColumn, lastRow)) {
+		return -1;
+	}
+
+	//Go through the tiles under the box, in the same order as the tile set
+	for(int row = firstRow; row <= lastRow; ++row) {
+		for(int column = firstColumn; column <= lastColumn; ++column) {
+			//If the tile is a wall type tile
+			Tile tile = tiles.getTile(column, row);
+			if(tile.isWall()) {
+				int i = row * tiles.getColumns() + column;
+
+				//If the collision box touches the wall tile
+				if(tile.isTopHalf()) {
+					contact = tiles.getCollisionBox(i);
+					if(checkCollision(box, contact)) {
+						return i;
+					}
+				}
+				else if(tile.isDiagonal()) {
+					if(tiles.touchesSlope(i, box, contact)) {
+						return i;
+					}
+				}
+				else {
+					contact = tiles.getBox(i);
+					if(checkCollision(box, contact)) {
+						return i;
+					}
+				}
+			}
+		}
+	}
+
+	//If no wall tiles were touched
+	return -1;
+}
+
+int touchesNpc(SDL_Rect box, SpatialHash &npcHash) {
+	//Lowest npc index touched, -1 if none
+	return npcHash.queryFirst(box);
+}
+
+void hashNpcs(std::vector<Npc *> &npcVector, SpatialHash &npcHash) {
+	npcHash.clear();
+	for(unsigned int i = 0; i < npcVector.size(); ++i) {
+		npcHash.insert(i, npcVector[i]->getBoxPosition());
+	}
+}
+
+int getNpcWidth(std::string sheet) {
+	return (int) ((sheet == "character4.png" ? 76 : 38) * gScale);
+}
+
+int getNpcHeight(std::string sheet) {
+	return (int) ((sheet == "character4.png" ? 105 : 55) * gScale);
+}
+
+Npc *spawnNpc(const NpcSpawn &spawn) {
+	return new Npc(spawn.x, spawn.y, getNpcWidth(spawn.sheet), getNpcHeight(spawn.sheet), spawn.sheet, spawn.seed);
+}
+
+void spawnNpcs(TileMap &tiles, Random &random, int count, std::vector<NpcSpawn> &npcSpawns, std::vector<Npc *> &npcVector) {
+	const char *npcSheets[5] = {"character2.png", "character2.png", "character3.png", "character1.png", "character4.png"};
+	for(int i = 0; i < count; ++i) {
+		std::string sheet = npcSheets[i % 5];
+		NpcSpawn spawn = {random.range(tiles.getWidth() - getNpcWidth(sheet)) + TILE_WIDTH, 0, sheet, random.next()};
+		npcSpawns.push_back(spawn);
+		npcVector.push_back(spawnNpc(spawn));
+	}
+}
+
+void recoverNpcs(std::vector<Npc *> &npcVector) {
+	for(unsigned int i = 0; i < npcVector.size(); ++i) {
+		if(npcVector[i]->wasStabbed) {
+			if(--npcVector[i]->recoverySteps <= 0) {
+				npcVector[i]->setVelocityX(0);
+				npcVector[i]->wasStabbed = false;
+			}
+		}
+	}
+}
+
+void thinkNpcs(std::vector<Npc *> &npcVector, Random &random) {
+	for(unsigned int i = 0; i < npcVector.size(); ++i) {
+		if(!npcVector[i]->wasStabbed) {
+			switch(random.range(3)) {
+				case 0:
+					npcVector[i]->isMoving = true;
+					npcVector[i]->setVelocityX(-npcVector[i]->NPC_VELX);
+					npcVector[i]->flip = SDL_FLIP_NONE;
+					break;
+				case 1:
+					npcVector[i]->isMoving = true;
+					npcVector[i]->setVelocityX(npcVector[i]->NPC_VELX);
+					npcVector[i]->flip = SDL_FLIP_HORIZONTAL;
+					break;
+				case 2:
+					npcVector[i]->isMoving = false;
+					npcVector[i]->setVelocityX(0);
+					break;
+				default:
+					break;
+			}
+		}
+	}
+}
+
+void updateNpcs(std::vector<Npc *> &npcVector, Random &random, Uint32 step) {
+	recoverNpcs(npcVector);
+
+	Uint32 thinkSteps = NPC_THINK_TIME * gSimulationRate;
+	if(step != 0 && step % thinkSteps == 0) {
+		thinkNpcs(npcVector, random);
+	}
+}
+
+void resetWorld(TileMap &tiles, Character &character, std::vector<Npc *> &npcVector, const std::vector<NpcSpawn> &npcSpawns, ParticlePool &particles, Random &random, const Random &startRandom) {
+	if(!setTiles(tiles, "lazy.map")) {
+		printf("Failed to load tile set!\n");
+	}
+
+	character.reset();
+
+	for(unsigned int i = 0; i < npcVector.size(); ++i) {
+		delete npcVector[i];
+	}
+	npcVector.clear();
+	for(unsigned int i = 0; i < npcSpawns.size(); ++i) {
+		npcVector.push_back(spawnNpc(npcSpawns[i]));
+	}
+
+	particles.clear();
+	random = startRandom;
+}
+
+SDL_Rect getSimulationArea(Character &character) {
+	SDL_Rect box = character.getBoxPosition();
+	SDL_Rect area = {box.x + box.w / 2 - SCREEN_WIDTH / 2, box.y + box.h / 2 - SCREEN_HEIGHT / 2, SCREEN_WIDTH, SCREEN_HEIGHT};
+	return area;
+}
+
+void stepSimulation(TileMap &tiles, Character &character, std::vector<Npc *> &npcVector, SpatialHash &npcHash, std::vector<NpcHit> &npcHits, ParticlePool &particles, JobSystem &jobs, float timeStep) {
+	// Have every chunk the step reads in memory, whatever the loader thread is up to.
+	{
+		PROFILE_ZONE("level streaming");
+		SDL_Rect area = getSimulationArea(character);
+		tiles.stream(area, true);
+	}
+
+	if(character.headJump == true) {
+		character.setVelocityY(0);
+		character.setVelocityY(-character.CHARACTER_VELY);
+		character.headJump = false;
+	}
+
+	//Move the character.
+	bool wasTap = character.tileTap;
+	{
+		PROFILE_ZONE("character move");
+		character.savePosition();
+		hashNpcs(npcVector, npcHash);
+		npcHits.clear();
+		character.move(tiles, npcVector, npcHash, npcHits, timeStep);
+		character.animate(timeStep);
+	}
+
+	// Age the particles before adding this step's.
+	particles.update();
+	particles.emit(character.particleEmitter, character.getBoxPosition(), timeStep);
+	if(character.tileTap && !wasTap) {
+		particles.burst(character.getBoxPosition(), TAP_PARTICLES);
+	}
+
+	// Apply what the character did to the npcs.
+	for(unsigned int i = 0; i < npcHits.size(); ++i) {
+		Npc *npc = npcVector[npcHits[i].npc];
+		if(!npcHits[i].jumped && !npc->wasStabbed) {
+			particles.burst(npc->getBoxPosition(), NPC_HIT_PARTICLES);
+		}
+		npc->applyHit(npcHits[i]);
+	}
+
+	// Move the npcs in parallel, each only writes itself.
+	// Those outside the simulation area wait where they are, their chunks are not loaded.
+	// Each chunk is a zone of the thread it ran on.
+	PROFILE_ZONE("npc move");
+	CharacterState state = character.getState();
+	jobs.parallelFor(npcVector.size(), 64, [&](int begin, int end) {
+		PROFILE_ZONE("npc chunk");
+		for(int i = begin; i < end; ++i) {
+			npcVector[i]->savePosition();
+			if(tiles.isLoaded(npcVector[i]->getBoxPosition())) {
+				npcVector[i]->move(tiles, state, timeStep);
+				npcVector[i]->animate(timeStep);
+			}
+		}
+	});
+
+	// Merge, dropping the npcs jumped on.
+	unsigned int kept = 0;
+	for(unsigned int i = 0; i < npcVector.size(); ++i) {
+		if(npcVector[i]->wasJumped) {
+			delete npcVector[i];
+		}
+		else {
+			npcVector[kept++] = npcVector[i];
+		}
+	}
+	npcVector.resize(kept);
+}
@@ -0,0 +1,60 @@
+#ifndef WORLD_HPP
+	#define WORLD_HPP
+#include <SDL.h>
+#include <string>
+#include <vector>
+#include "tilemap.hpp"
+#include "spatialhash.hpp"
+#include "jobs.hpp"
+#include "particle.hpp"
+#include "random.hpp"
+#include "npc.hpp"
+#include "character.hpp"
+
+//The level, collision and simulation steps, apart from the window so they also run in the benchmarks
+
+//Sets tiles from tile map
+bool setTiles(TileMap &tiles, std::string mapName);
+
+//Box collision detector
+bool checkCollision(SDL_Rect a, SDL_Rect b);
+
+//Checks collision box against set of tiles
+int touchesWall(SDL_Rect box, TileMap &tiles, SDL_Rect &contact);
+bool touchesTap(SDL_Rect box, TileMap &tiles);
+
+int touchesNpc(SDL_Rect box, SpatialHash &npcHash);
+
+//Hashes the current npc boxes for touchesNpc
+void hashNpcs(std::vector<Npc *> &npcVector, SpatialHash &npcHash);
+
+//Npc size for a sprite sheet
+int getNpcWidth(std::string sheet);
+int getNpcHeight(std::string sheet);
+
+//Creates an npc where a spawn says, animated by the set of its sheet
+Npc *spawnNpc(const NpcSpawn &spawn);
+
+//Spreads count npcs over the level, cycling through the sheets, keeping their spawns for a restart
+void spawnNpcs(TileMap &tiles, Random &random, int count, std::vector<NpcSpawn> &npcSpawns, std::vector<Npc *> &npcVector);
+
+//Npc behaviour between steps, recovering from stabs and picking where to walk
+void recoverNpcs(std::vector<Npc *> &npcVector);
+void thinkNpcs(std::vector<Npc *> &npcVector, Random &random);
+
+//Npc behaviour before a step, thinking every NPC_THINK_TIME of simulated time
+//step counts from when the world started or was reset
+void updateNpcs(std::vector<Npc *> &npcVector, Random &random, Uint32 step);
+
+//Puts the level, character and npcs back the way they started, keeping the window and every loaded file
+//The world random sequence goes back to where it was once the npcs were spawned
+void resetWorld(TileMap &tiles, Character &character, std::vector<Npc *> &npcVector, const std::vector<NpcSpawn> &npcSpawns, ParticlePool &particles, Random &random, const Random &startRandom);
+
+//Screen sized box around the character, the level is streamed around it rather than the camera
+//Npcs outside it, and outside the chunks of margin streamed with it, do not move
+SDL_Rect getSimulationArea(Character &character);
+
+//Advances the character and npcs by one fixed step
+//Streams the simulation area first and waits for it, so the same inputs step the same however fast the loader is
+void stepSimulation(TileMap &tiles, Character &character, std::vector<Npc *> &npcVector, SpatialHash &npcHash, std::vector<NpcHit> &npcHits, ParticlePool &particles, JobSystem &jobs, float timeStep);
+#endif